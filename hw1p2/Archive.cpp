@@ -0,0 +1,347 @@
+// Archive.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+#pragma comment(lib, "Cabinet.lib")
+
+using namespace std;
+
+// writes out everything queued and stops the writer
+Archive::~Archive()
+{
+	Stop();
+}
+
+/*
+ * Function: Start
+ * ------------------
+ * Creates the archive directory if needed, opens the first archive and index
+ * file and starts the writer thread. Numbering starts after any archives
+ * already in the directory, so a resumed crawl adds to an earlier one instead
+ * of overwriting it.
+ *
+ * input:
+ *   - _dir: directory to write the archives to
+ *   - _prefix: start of every file name, so several shards can share _dir
+ *
+ * return: -1 if the directory or files could not be created, 0 otherwise
+ */
+int Archive::Start(const string &_dir, const string &_prefix)
+{
+	dir = _dir;
+	prefix = _prefix;
+
+	if (!CreateDirectoryA(dir.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+	{
+		printf("CreateDirectory generated error %lu for %s\n", (unsigned long) GetLastError(), dir.c_str());
+		return -1;
+	}
+
+	if (!CreateCompressor(COMPRESS_ALGORITHM_XPRESS, NULL, &compressor))
+	{
+		printf("CreateCompressor generated error %lu\n", (unsigned long) GetLastError());
+		return -1;
+	}
+
+	if (Rotate() < 0)
+		return -1;
+
+	batch.reserve(ARCHIVE_BATCH_SIZE);
+	writer = thread(&Archive::Run, this);
+	return 0;
+}
+
+// queues a copy of a response fetched from url, dropping it if the writer is too far behind
+void Archive::Add(string_view url, const char *response, size_t size)
+{
+	// copied before taking the lock, which every fetch thread and the writer share
+	Record record;
+	record.url.assign(url.data(), url.size());
+	record.response.assign(response, response + size);
+	GetSystemTime(&record.fetched);
+
+	{
+		lock_guard<mutex> guard(lock);
+		if (failed || queued_bytes + size > MAX_ARCHIVE_QUEUED)
+		{
+			dropped++;
+			return;
+		}
+
+		queued_bytes += size;
+		pending.push_back(move(record));
+	}
+	wake.notify_one();
+}
+
+// writes out everything queued and stops the writer
+void Archive::Stop()
+{
+	if (!writer.joinable())
+		return;
+
+	{
+		lock_guard<mutex> guard(lock);
+		stop = true;
+	}
+	wake.notify_one();
+	writer.join();
+
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	if (index_file != INVALID_HANDLE_VALUE)
+		CloseHandle(index_file);
+	file = index_file = INVALID_HANDLE_VALUE;
+
+	if (compressor != NULL)
+		CloseCompressor(compressor);
+	compressor = NULL;
+}
+
+// prints how many records were archived and dropped
+void Archive::Print()
+{
+	lock_guard<mutex> guard(lock);
+	printf("Archive: %" PRIu64 " pages, %.1f MB stored for %.1f MB, %" PRIu64 " dropped\n",
+	       records, stored_bytes / 1e6, raw_bytes / 1e6, dropped);
+}
+
+/*
+ * Function: Run
+ * ------------------
+ * Body of the writer thread. Takes everything queued at once so fetch threads
+ * hold the lock only to append, compresses the records into the batch and
+ * writes the batch whenever it reaches ARCHIVE_BATCH_SIZE. A partial batch is
+ * written once no record has arrived for ARCHIVE_FLUSH_SECONDS, and whatever
+ * is left when Stop is called is written before returning. After a failed
+ * write the thread keeps emptying the queue, counting records as dropped.
+ */
+void Archive::Run()
+{
+	vector<Record> taken;
+	unique_lock<mutex> guard(lock);
+
+	for (;;)
+	{
+		if (pending.empty() && !stop)
+		{
+			wake.wait_for(guard, chrono::seconds(ARCHIVE_FLUSH_SECONDS));
+			if (pending.empty() && !stop && !batch.empty())
+			{
+				guard.unlock();
+				int ret = Flush();
+				guard.lock();
+				failed = failed || (ret < 0);
+			}
+			continue;
+		}
+
+		if (pending.empty())
+			break;
+
+		taken.swap(pending);
+		queued_bytes = 0;
+		bool was_failed = failed;
+		guard.unlock();
+
+		uint64_t raw = 0, stored = 0;
+		size_t appended = 0;
+		int ret = 0;
+		for (const Record &record : taken)
+		{
+			if (was_failed || ret < 0)
+				break;
+
+			size_t record_size = 0;
+			ret = Append(record, record_size);
+			if (ret < 0)
+				break;
+
+			raw += record.response.size();
+			stored += record_size;
+			appended++;
+
+			if (batch.size() >= ARCHIVE_BATCH_SIZE)
+				ret = Flush();
+		}
+
+		guard.lock();
+		failed = failed || (ret < 0);
+		records += appended;
+		dropped += taken.size() - appended;
+		raw_bytes += raw;
+		stored_bytes += stored;
+		taken.clear();
+	}
+
+	guard.unlock();
+	if (!failed && Flush() < 0)
+	{
+		guard.lock();
+		failed = true;
+	}
+}
+
+/*
+ * Function: Append
+ * ------------------
+ * Compresses the response in record and appends it to the batch as a WARC
+ * response record, along with its line in the index. The block is stored
+ * uncompressed when XPRESS cannot make it smaller, and WARC-Block-Encoding
+ * says which was done. Switches to the next archive first if the record would
+ * take the current one past ARCHIVE_FILE_SIZE.
+ *
+ * input:
+ *   - record: response to archive
+ * output:
+ *   - record_size: bytes the record takes in the archive
+ *
+ * return: -1 if the archive could not be rotated, 0 otherwise
+ */
+int Archive::Append(const Record &record, size_t &record_size)
+{
+	const char *block = record.response.data();
+	size_t block_size = record.response.size();
+	const char *encoding = "identity";
+
+	// a block that does not fit in its original size is not worth compressing
+	SIZE_T compressed_size = 0;
+	compressed.resize(block_size);
+	if (block_size > 0 && Compress(compressor, block, block_size, compressed.data(), compressed.size(), &compressed_size) &&
+	    compressed_size < block_size)
+	{
+		block = compressed.data();
+		block_size = compressed_size;
+		encoding = "xpress";
+	}
+
+	const SYSTEMTIME &t = record.fetched;
+	char header[MAX_URL_LEN + 512];
+	int header_len = snprintf(header, sizeof(header),
+	                          "WARC/1.1\r\n"
+	                          "WARC-Type: response\r\n"
+	                          "WARC-Record-ID: <urn:hw1p2:%s-%" PRIu64 ">\r\n"
+	                          "WARC-Date: %04u-%02u-%02uT%02u:%02u:%02uZ\r\n"
+	                          "WARC-Target-URI: %.*s\r\n"
+	                          "WARC-Block-Encoding: %s\r\n"
+	                          "WARC-Block-Length: %zu\r\n"
+	                          "Content-Type: application/http;msgtype=response\r\n"
+	                          "Content-Length: %zu\r\n"
+	                          "\r\n",
+	                          file_name.c_str(), record_number, t.wYear, t.wMonth, t.wDay, t.wHour, t.wMinute, t.wSecond,
+	                          (int) min(record.url.size(), (size_t) MAX_URL_LEN), record.url.data(), encoding,
+	                          record.response.size(), block_size);
+	if (header_len < 0 || header_len >= (int) sizeof(header))
+		header_len = (int) strlen(header);
+
+	record_size = header_len + block_size + 4;
+	uint64_t offset = file_offset + batch.size();
+	if (offset > 0 && offset + record_size > ARCHIVE_FILE_SIZE)
+	{
+		if (Rotate() < 0)
+			return -1;
+		offset = 0;
+	}
+
+	batch.insert(batch.end(), header, header + header_len);
+	batch.insert(batch.end(), block, block + block_size);
+	batch.insert(batch.end(), { '\r', '\n', '\r', '\n' });
+
+	index_batch += to_string(offset) + " " + to_string(record_size) + " " + record.url + "\n";
+	record_number++;
+	return 0;
+}
+
+// writes both batches out, returns -1 for failure and 0 for success
+int Archive::Flush()
+{
+	// writes all of data to handle, false if the disk refuses any of it
+	auto write_all = [](HANDLE handle, const char *data, size_t size)
+	{
+		while (size > 0)
+		{
+			DWORD written = 0;
+			if (!WriteFile(handle, data, (DWORD) min(size, (size_t) MAXDWORD), &written, NULL) || written == 0)
+				return false;
+
+			data += written;
+			size -= written;
+		}
+		return true;
+	};
+
+	if (!write_all(file, batch.data(), batch.size()) || !write_all(index_file, index_batch.data(), index_batch.size()))
+	{
+		printf("WriteFile generated error %lu, archiving stopped\n", (unsigned long) GetLastError());
+		batch.clear();
+		index_batch.clear();
+		return -1;
+	}
+
+	file_offset += batch.size();
+	batch.clear();
+	index_batch.clear();
+	return 0;
+}
+
+/*
+ * Function: Rotate
+ * ------------------
+ * Writes out and closes the current archive and index file, if any, and
+ * creates the next numbered pair. Numbers already taken in the directory are
+ * skipped.
+ *
+ * return: -1 if the current files could not be written or no new file could
+ *         be created, 0 otherwise
+ */
+int Archive::Rotate()
+{
+	int ret = 0;
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		ret = Flush();
+		CloseHandle(file);
+		CloseHandle(index_file);
+		file = index_file = INVALID_HANDLE_VALUE;
+	}
+	if (ret < 0)
+		return -1;
+
+	for (;; file_number++)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "-%05u", file_number);
+		string base = dir + "\\" + prefix + name;
+
+		// the archive claims the number, a file that already exists means an earlier crawl used it
+		file = CreateFileA((base + ".warc").c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_NEW,
+		                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			if (GetLastError() == ERROR_FILE_EXISTS)
+				continue;
+
+			printf("CreateFile generated error %lu for %s.warc\n", (unsigned long) GetLastError(), base.c_str());
+			return -1;
+		}
+
+		index_file = CreateFileA((base + ".idx").c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS,
+		                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (index_file == INVALID_HANDLE_VALUE)
+		{
+			printf("CreateFile generated error %lu for %s.idx\n", (unsigned long) GetLastError(), base.c_str());
+			CloseHandle(file);
+			file = INVALID_HANDLE_VALUE;
+			return -1;
+		}
+
+		file_name = prefix + name;
+		file_number++;
+		file_offset = 0;
+		record_number = 0;
+		return 0;
+	}
+}
@@ -0,0 +1,114 @@
+// Archive.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// archive files are rotated once they reach this size (1GB)
+const uint64_t ARCHIVE_FILE_SIZE = 1024ULL * 1024 * 1024;
+
+// records are gathered into writes of at least this size (4MB)
+const size_t ARCHIVE_BATCH_SIZE = 4 * 1024 * 1024;
+
+// most bytes waiting for the writer before new records are dropped (64MB)
+const size_t MAX_ARCHIVE_QUEUED = 64 * 1024 * 1024;
+
+// seconds a partial batch may wait before it is written anyway
+const UINT ARCHIVE_FLUSH_SECONDS = 1;
+
+/*
+ * Writes every crawled page (headers and body) to WARC-style files in a
+ * directory so pages can be reprocessed without crawling them again. Files are
+ * named <prefix>-NNNNN.warc and are rotated at ARCHIVE_FILE_SIZE, each with a
+ * <prefix>-NNNNN.idx listing "<offset> <length> <url>" for its records, where
+ * offset and length cover the whole record.
+ *
+ * The format is not standard WARC. Each record is an uncompressed WARC/1.1
+ * header (WARC-Type: response, WARC-Record-ID, WARC-Date, WARC-Target-URI),
+ * a blank line, Content-Length bytes of block and "\r\n\r\n". The block is
+ * the HTTP response compressed on its own with the Windows Compression API's
+ * XPRESS in buffer mode, so any record can be decompressed without the ones
+ * before it (Decompress with COMPRESS_ALGORITHM_XPRESS). Two extra header
+ * fields describe it: WARC-Block-Encoding is "xpress", or "identity" when the
+ * response did not get smaller and is stored as is, and WARC-Block-Length is
+ * the size of the response before compression. WARC tools can walk the
+ * records using Content-Length, but only identity blocks are readable by them.
+ * The standard per-record .warc.gz would need a deflate library, which this
+ * project does not link.
+ *
+ * Fetch threads only copy the page into a queue. A single writer thread
+ * compresses the records and gathers them into ARCHIVE_BATCH_SIZE writes. If
+ * the writer falls MAX_ARCHIVE_QUEUED bytes behind, new records are dropped
+ * (and counted) rather than slowing the crawl down.
+ */
+class Archive
+{
+	struct Record
+	{
+		std::string url;
+		std::vector<char> response;
+		SYSTEMTIME fetched;
+	};
+
+	std::string dir;
+	std::string prefix;
+
+	// records waiting for the writer and their total size, guarded by lock
+	std::mutex lock;
+	std::condition_variable wake;
+	std::vector<Record> pending;
+	size_t queued_bytes;
+	bool stop;
+	bool failed; // set once a write fails, later records are dropped
+	std::thread writer;
+
+	// state below is only used by the writer thread once it has started
+	HANDLE file;
+	HANDLE index_file;
+	unsigned file_number;    // number the next file will try
+	std::string file_name;   // prefix and number of file, names its records
+	uint64_t record_number;  // records already in file
+	uint64_t file_offset;    // bytes written to file
+	std::vector<char> batch; // records not yet written to file
+	std::string index_batch; // index lines not yet written to index_file
+	COMPRESSOR_HANDLE compressor;
+	std::vector<char> compressed;
+
+	// totals, guarded by lock
+	uint64_t records;
+	uint64_t dropped;
+	uint64_t raw_bytes;
+	uint64_t stored_bytes;
+
+	// writer thread body, archives queued records until stopped
+	void Run();
+
+	// compresses a record and appends it and its index line to the batches, returns -1 for failure and 0 for success
+	int Append(const Record &record, size_t &record_size);
+
+	// writes both batches out, returns -1 for failure and 0 for success
+	int Flush();
+
+	// closes the current files and opens the next pair, returns -1 for failure and 0 for success
+	int Rotate();
+
+public:
+	Archive() : queued_bytes{ 0 }, stop{ false }, failed{ false }, file{ INVALID_HANDLE_VALUE }, index_file{ INVALID_HANDLE_VALUE },
+		file_number{ 0 }, record_number{ 0 }, file_offset{ 0 }, compressor{ NULL }, records{ 0 }, dropped{ 0 }, raw_bytes{ 0 }, stored_bytes{ 0 } {}
+
+	// writes out everything queued and stops the writer
+	~Archive();
+
+	// creates _dir if needed, opens the first file and starts the writer, returns -1 for failure and 0 for success
+	int Start(const std::string &_dir, const std::string &_prefix);
+
+	// queues a copy of a response fetched from url, dropping it if the writer is too far behind
+	void Add(std::string_view url, const char *response, size_t size);
+
+	// writes out everything queued and stops the writer
+	void Stop();
+
+	// prints how many records were archived and dropped
+	void Print();
+};
@@ -0,0 +1,87 @@
+// Arena.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// allocates the first block
+Arena::Arena(size_t initial_size)
+{
+	head = NewBlock(initial_size);
+	pos = (char*) (head + 1);
+	end = (char*) head + head->size;
+}
+
+// frees every block
+Arena::~Arena()
+{
+	while (head != nullptr)
+	{
+		Block *next = head->next;
+		free(head);
+		head = next;
+	}
+}
+
+// mallocs a block of size bytes (including its header), throws std::bad_alloc on failure
+Arena::Block *Arena::NewBlock(size_t size)
+{
+	Block *block = (Block*) malloc(size);
+	if (block == NULL)
+		throw bad_alloc();
+
+	block->next = nullptr;
+	block->size = size;
+	return block;
+}
+
+// bumps pos past an aligned allocation, chaining a new block when the current one is full
+void *Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	uintptr_t aligned = ((uintptr_t) pos + alignment - 1) & ~(uintptr_t) (alignment - 1);
+
+	if (aligned + bytes > (uintptr_t) end || aligned + bytes < aligned)
+	{
+		// double the block size each time so a URL needs only a few blocks
+		size_t size = head->size * 2;
+		if (size < sizeof(Block) + bytes + alignment)
+			size = sizeof(Block) + bytes + alignment;
+
+		Block *block = NewBlock(size);
+		block->next = head;
+		head = block;
+		pos = (char*) (head + 1);
+		end = (char*) head + head->size;
+
+		aligned = ((uintptr_t) pos + alignment - 1) & ~(uintptr_t) (alignment - 1);
+	}
+
+	pos = (char*) (aligned + bytes);
+	return (void*) aligned;
+}
+
+// releases every allocation at once, anything allocated from the arena must no longer be in use
+void Arena::Reset()
+{
+	// only the first block is left when this URL fit in it
+	if (head->next != nullptr)
+	{
+		size_t total = 0;
+		while (head != nullptr)
+		{
+			Block *next = head->next;
+			total += head->size;
+			free(head);
+			head = next;
+		}
+
+		// next URL likely needs as much, so start with one block that holds it all
+		head = NewBlock(total < ARENA_MAX_RETAINED ? total : ARENA_MAX_RETAINED);
+	}
+
+	pos = (char*) (head + 1);
+	end = (char*) head + head->size;
+}
@@ -0,0 +1,54 @@
+// Arena.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// size of the first block an arena allocates
+const size_t ARENA_BLOCK_SIZE = 16 * 1024;
+
+// largest first block an arena will keep between resets
+const size_t ARENA_MAX_RETAINED = 1024 * 1024;
+
+/*
+ * Bump allocator for memory that only lives as long as one URL. Allocations
+ * advance a pointer through the current block, deallocation does nothing and
+ * Reset releases everything at once. If a URL needed more than the first block,
+ * Reset replaces it with one large enough for everything that was used, so a
+ * steady crawl settles on a single block and stops calling malloc entirely.
+ *
+ * Derives from std::pmr::memory_resource so standard containers can use it.
+ * An arena is not thread safe, each crawler thread needs its own.
+ */
+class Arena : public std::pmr::memory_resource
+{
+	// header at the start of every block, blocks are linked newest first
+	struct Block
+	{
+		Block *next;
+		size_t size;
+	};
+
+	Block *head;
+	char *pos; // next free byte in head
+	char *end; // end of head
+
+	// mallocs a block of size bytes (including its header), throws std::bad_alloc on failure
+	static Block *NewBlock(size_t size);
+
+protected:
+	void *do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override {}
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+public:
+	explicit Arena(size_t initial_size = ARENA_BLOCK_SIZE);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena &operator=(const Arena&) = delete;
+
+	// releases every allocation at once, anything allocated from the arena must no longer be in use
+	void Reset();
+};
@@ -0,0 +1,100 @@
+// BoundedQueue.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+/*
+ * Fixed size lock-free queue for any number of producers and consumers
+ * (Dmitry Vyukov's bounded MPMC queue). Every cell carries a sequence number
+ * saying whether it is ready to be written or read for the current lap, so a
+ * push or pop claims its position with one compare-and-swap and never waits on
+ * another thread. TryPush and TryPop fail instead of blocking when the queue is
+ * full or empty, callers that need to wait pair the queue with semaphores.
+ */
+template <typename T>
+class BoundedQueue
+{
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	size_t mask;
+
+	// kept on separate cache lines so producers and consumers do not contend
+	alignas(64) std::atomic<size_t> enqueue_pos;
+	alignas(64) std::atomic<size_t> dequeue_pos;
+
+public:
+	// capacity must be a power of two
+	explicit BoundedQueue(size_t capacity) : cells{ new Cell[capacity] }, mask{ capacity - 1 }, enqueue_pos{ 0 }, dequeue_pos{ 0 }
+	{
+		for (size_t i = 0; i < capacity; i++)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue &operator=(const BoundedQueue&) = delete;
+
+	// moves value into the queue, returns false if the queue is full
+	bool TryPush(T &&value)
+	{
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell &cell = cells[pos & mask];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+
+			// cell is free for this lap, try to claim it
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.data = std::move(value);
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			// cell still holds an item from the previous lap
+			else if (diff < 0)
+				return false;
+			// another producer claimed it first
+			else
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	// moves the oldest item into value, returns false if the queue is empty
+	bool TryPop(T &value)
+	{
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell &cell = cells[pos & mask];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+
+			// cell has been written for this lap, try to claim it
+			if (diff == 0)
+			{
+				if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					value = std::move(cell.data);
+					cell.sequence.store(pos + mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			// nothing written here yet
+			else if (diff < 0)
+				return false;
+			// another consumer claimed it first
+			else
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+};
@@ -0,0 +1,309 @@
+// Checkpoint.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// journal record types, each followed by its fixed or length-prefixed payload
+const int RECORD_HOST = 'H';     // uint16_t length, host name
+const int RECORD_IP = 'I';       // DWORD IP address
+const int RECORD_PROGRESS = 'P'; // int64_t input offset, CrawlStats
+
+// prints a summary of the crawl
+void CrawlStats::Print() const
+{
+	printf("\nExtracted %" PRIu64 " URLs\n", urls);
+	printf("\tpassed host uniqueness: %" PRIu64 "\n", unique_hosts);
+	printf("\tsuccessful DNS lookups: %" PRIu64 "\n", dns_lookups);
+	printf("\tpassed IP uniqueness: %" PRIu64 "\n", unique_ips);
+	printf("\tpassed robots check: %" PRIu64 "\n", robots_passed);
+	printf("\tcrawled %" PRIu64 " pages (%" PRIu64 " bytes) with %" PRIu64 " links\n", pages, bytes, links);
+	printf("\tskipped %" PRIu64 " duplicate pages\n", duplicates);
+}
+
+// writes the totals to out as a single line that ParseReport can read back
+void CrawlStats::Report(FILE *out) const
+{
+	fprintf(out, "%s %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+		    STATS_REPORT_TAG, urls, unique_hosts, dns_lookups, unique_ips, robots_passed, pages, bytes, duplicates, links);
+}
+
+// reads totals written by Report from line, returns false if line is not a report
+bool CrawlStats::ParseReport(const char *line)
+{
+	size_t tag_len = strlen(STATS_REPORT_TAG);
+	if (strncmp(line, STATS_REPORT_TAG, tag_len) != 0 || line[tag_len] != ' ')
+		return false;
+
+	return sscanf_s(line + tag_len, "%" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64,
+	                &urls, &unique_hosts, &dns_lookups, &unique_ips, &robots_passed, &pages, &bytes, &duplicates, &links) == 9;
+}
+
+// adds the totals from another crawl
+CrawlStats &CrawlStats::operator+=(const CrawlStats &other)
+{
+	urls += other.urls;
+	unique_hosts += other.unique_hosts;
+	dns_lookups += other.dns_lookups;
+	unique_ips += other.unique_ips;
+	robots_passed += other.robots_passed;
+	pages += other.pages;
+	bytes += other.bytes;
+	duplicates += other.duplicates;
+	links += other.links;
+	return *this;
+}
+
+// stops the background thread, writing a final snapshot
+Checkpoint::~Checkpoint()
+{
+	Stop();
+}
+
+/*
+ * Function: Load
+ * ------------------
+ * Reads a checkpoint journal, applying every snapshot up to the last complete
+ * progress record. Anything after that record (e.g. a snapshot cut short by
+ * a crash) is ignored.
+ *
+ * input:
+ *   - path: checkpoint file written by a previous crawl
+ * output:
+ *   - seen_ips, seen_hosts: filled with the IPs and hosts already visited
+ *   - input_offset: position in the input file to resume reading from
+ *   - crawl_stats: totals for the crawl so far
+ *
+ * return: -1 if the file could not be read, 0 otherwise
+ */
+int Checkpoint::Load(const string &path, unordered_set<DWORD> &seen_ips, unordered_set<string> &seen_hosts,
+	                 int64_t &input_offset, CrawlStats &crawl_stats)
+{
+	FILE *in = NULL;
+	if (fopen_s(&in, path.c_str(), "rb") != 0 || in == NULL)
+	{
+		printf("checkpoint %s could not be opened for reading\n", path.c_str());
+		return -1;
+	}
+
+	uint32_t header[2];
+	if (fread(header, sizeof(uint32_t), 2, in) != 2 || header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION)
+	{
+		printf("%s is not a valid checkpoint\n", path.c_str());
+		fclose(in);
+		return -1;
+	}
+
+	// hosts and IPs are only applied once the progress record that follows them is read
+	vector<string> hosts;
+	vector<DWORD> ips;
+	int type;
+
+	while ((type = fgetc(in)) != EOF)
+	{
+		if (type == RECORD_HOST)
+		{
+			uint16_t len;
+			if (fread(&len, sizeof(len), 1, in) != 1)
+				break;
+
+			string host(len, '\0');
+			if (fread(&host[0], 1, len, in) != len)
+				break;
+
+			hosts.push_back(move(host));
+		}
+		else if (type == RECORD_IP)
+		{
+			DWORD IP;
+			if (fread(&IP, sizeof(IP), 1, in) != 1)
+				break;
+
+			ips.push_back(IP);
+		}
+		else if (type == RECORD_PROGRESS)
+		{
+			int64_t snapshot_offset;
+			CrawlStats snapshot_stats;
+			if (fread(&snapshot_offset, sizeof(snapshot_offset), 1, in) != 1 || fread(&snapshot_stats, sizeof(snapshot_stats), 1, in) != 1)
+				break;
+
+			seen_hosts.insert(make_move_iterator(hosts.begin()), make_move_iterator(hosts.end()));
+			seen_ips.insert(ips.begin(), ips.end());
+			hosts.clear();
+			ips.clear();
+
+			input_offset = snapshot_offset;
+			crawl_stats = snapshot_stats;
+		}
+		// unknown record, the rest of the file cannot be trusted
+		else
+			break;
+	}
+
+	fclose(in);
+	printf("Resuming at offset %" PRId64 " with %zu hosts and %zu IPs seen\n", input_offset, seen_hosts.size(), seen_ips.size());
+	return 0;
+}
+
+/*
+ * Function: Start
+ * ------------------
+ * Writes the current crawl state to a fresh journal (replacing any previous one
+ * only once it is complete) and starts the background thread that appends to it.
+ *
+ * input:
+ *   - path: checkpoint file to write
+ *   - seen_ips, seen_hosts: IPs and hosts already visited (empty for a new crawl)
+ *   - input_offset: position in the input file the crawl starts from
+ *   - crawl_stats: totals for the crawl so far
+ *
+ * return: -1 if the journal could not be written, 0 otherwise
+ */
+int Checkpoint::Start(const string &path, const unordered_set<DWORD> &seen_ips, const unordered_set<string> &seen_hosts,
+	                  int64_t input_offset, const CrawlStats &crawl_stats)
+{
+	string temp_path = path + ".tmp";
+	if (fopen_s(&file, temp_path.c_str(), "wb") != 0 || file == NULL)
+	{
+		printf("checkpoint %s could not be opened for writing\n", temp_path.c_str());
+		file = NULL;
+		return -1;
+	}
+
+	// compact everything loaded so far into a single snapshot
+	uint32_t header[2] = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION };
+	fwrite(header, sizeof(uint32_t), 2, file);
+	if (WriteSnapshot(vector<string>(seen_hosts.begin(), seen_hosts.end()), vector<DWORD>(seen_ips.begin(), seen_ips.end()),
+		              input_offset, crawl_stats) < 0)
+	{
+		fclose(file);
+		file = NULL;
+		return -1;
+	}
+	fclose(file);
+	file = NULL;
+
+	if (!MoveFileExA(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		printf("checkpoint %s could not be replaced, error %lu\n", path.c_str(), (unsigned long) GetLastError());
+		return -1;
+	}
+
+	if (fopen_s(&file, path.c_str(), "ab") != 0 || file == NULL)
+	{
+		printf("checkpoint %s could not be opened for writing\n", path.c_str());
+		file = NULL;
+		return -1;
+	}
+
+	offset = input_offset;
+	stats = crawl_stats;
+	stop = false;
+	running = true;
+	writer = thread(&Checkpoint::Run, this);
+	return 0;
+}
+
+// records that every URL before input_offset has been completed, along with the host and IP (if any) of the URL just finished
+void Checkpoint::RecordProgress(int64_t input_offset, const CrawlStats &crawl_stats, string_view host, DWORD IP)
+{
+	lock_guard<mutex> guard(lock);
+	if (!running)
+		return;
+
+	// taken in the same step as the offset, so no snapshot can hold one without the other
+	if (!host.empty())
+		new_hosts.emplace_back(host);
+	if (IP != 0)
+		new_ips.push_back(IP);
+
+	offset = input_offset;
+	stats = crawl_stats;
+	dirty = true;
+}
+
+// writes a final snapshot and stops the background thread
+void Checkpoint::Stop()
+{
+	{
+		lock_guard<mutex> guard(lock);
+		running = false;
+		stop = true;
+	}
+	wake.notify_one();
+
+	if (writer.joinable())
+		writer.join();
+
+	if (file != NULL)
+	{
+		fclose(file);
+		file = NULL;
+	}
+}
+
+// background thread body, writes a snapshot every CHECKPOINT_INTERVAL seconds until stopped
+void Checkpoint::Run()
+{
+	unique_lock<mutex> guard(lock);
+
+	// always makes one last pass after being stopped so the final state is written
+	for (;;)
+	{
+		wake.wait_for(guard, chrono::seconds(CHECKPOINT_INTERVAL), [this] { return stop; });
+
+		if (dirty)
+		{
+			// take the pending changes so the crawler is only held up for the swap
+			vector<string> hosts;
+			vector<DWORD> ips;
+			hosts.swap(new_hosts);
+			ips.swap(new_ips);
+			int64_t snapshot_offset = offset;
+			CrawlStats snapshot_stats = stats;
+			dirty = false;
+
+			guard.unlock();
+			WriteSnapshot(hosts, ips, snapshot_offset, snapshot_stats);
+			guard.lock();
+		}
+
+		if (stop)
+			break;
+	}
+}
+
+// appends the changes taken from the crawler to the journal, returns -1 for failure and 0 for success
+int Checkpoint::WriteSnapshot(const vector<string> &hosts, const vector<DWORD> &ips, int64_t snapshot_offset, const CrawlStats &snapshot_stats)
+{
+	for (const string &host : hosts)
+	{
+		uint16_t len = (uint16_t) host.length();
+		fputc(RECORD_HOST, file);
+		fwrite(&len, sizeof(len), 1, file);
+		fwrite(host.data(), 1, len, file);
+	}
+
+	for (DWORD IP : ips)
+	{
+		fputc(RECORD_IP, file);
+		fwrite(&IP, sizeof(IP), 1, file);
+	}
+
+	// progress record commits everything written before it
+	fputc(RECORD_PROGRESS, file);
+	fwrite(&snapshot_offset, sizeof(snapshot_offset), 1, file);
+	fwrite(&snapshot_stats, sizeof(snapshot_stats), 1, file);
+
+	if (fflush(file) != 0 || ferror(file))
+	{
+		printf("checkpoint write failed\n");
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+// Checkpoint.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// seconds between snapshots written by the background thread
+const UINT CHECKPOINT_INTERVAL = 5;
+
+// starts the line a crawl's totals are reported on by CrawlStats::Report
+const char STATS_REPORT_TAG[] = "STATS";
+
+// identifies a checkpoint file and its format version
+const uint32_t CHECKPOINT_MAGIC = 0x4b435243; // "CRCK"
+const uint32_t CHECKPOINT_VERSION = 2;
+
+// running totals for a crawl, stored with each checkpoint
+struct CrawlStats
+{
+	uint64_t urls;          // URLs read from the input file
+	uint64_t unique_hosts;  // URLs that passed host uniqueness
+	uint64_t dns_lookups;   // successful DNS lookups
+	uint64_t unique_ips;    // URLs that passed IP uniqueness
+	uint64_t robots_passed; // hosts without a robots.txt (4XX response)
+	uint64_t pages;         // pages downloaded with a 2XX response
+	uint64_t bytes;         // bytes downloaded for those pages
+	uint64_t duplicates;    // pages skipped as exact or near duplicates of earlier ones
+	uint64_t links;         // links found on the other pages
+
+	CrawlStats() : urls{ 0 }, unique_hosts{ 0 }, dns_lookups{ 0 }, unique_ips{ 0 }, robots_passed{ 0 }, pages{ 0 }, bytes{ 0 }, duplicates{ 0 },
+		           links{ 0 } {}
+
+	// prints a summary of the crawl
+	void Print() const;
+
+	// writes the totals to out as a single line that ParseReport can read back
+	void Report(FILE *out) const;
+
+	// reads totals written by Report from line, returns false if line is not a report
+	bool ParseReport(const char *line);
+
+	// adds the totals from another crawl
+	CrawlStats &operator+=(const CrawlStats &other);
+};
+
+/*
+ * Journal of crawl state that can be reloaded after a restart. Once a URL is
+ * finished, the crawler records the host and IP it added to the uniqueness
+ * sets together with its progress through the input file, and a background
+ * thread appends the changes to disk every CHECKPOINT_INTERVAL seconds. A host
+ * is never saved before the offset has moved past its URL's line, so a resumed
+ * crawl does not find it already seen and skip the URL. Every progress record
+ * commits the hosts and IPs written before it, so a journal cut short by a
+ * crash still loads up to its last complete snapshot.
+ *
+ * Nothing is recorded unless the checkpoint has been started.
+ */
+class Checkpoint
+{
+	FILE *file;
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::thread writer;
+	bool running; // between Start and Stop
+	bool stop;
+
+	// state recorded since the last snapshot was written, guarded by lock
+	std::vector<std::string> new_hosts;
+	std::vector<DWORD> new_ips;
+	int64_t offset;
+	CrawlStats stats;
+	bool dirty;
+
+	// background thread body, writes a snapshot every CHECKPOINT_INTERVAL seconds until stopped
+	void Run();
+
+	// appends the changes taken from the crawler to the journal
+	int WriteSnapshot(const std::vector<std::string> &hosts, const std::vector<DWORD> &ips, int64_t snapshot_offset, const CrawlStats &snapshot_stats);
+
+public:
+	Checkpoint() : file{ NULL }, running{ false }, stop{ false }, offset{ 0 }, dirty{ false } {}
+
+	// stops the background thread, writing a final snapshot
+	~Checkpoint();
+
+	/*
+	 * input:
+	 *   - path: checkpoint file written by a previous crawl
+	 * output:
+	 *   - seen_ips, seen_hosts: filled with the IPs and hosts already visited
+	 *   - input_offset: position in the input file to resume reading from
+	 *   - crawl_stats: totals for the crawl so far
+	 * return: -1 if the file could not be read, 0 otherwise
+	 */
+	static int Load(const std::string &path, std::unordered_set<DWORD> &seen_ips, std::unordered_set<std::string> &seen_hosts,
+		            int64_t &input_offset, CrawlStats &crawl_stats);
+
+	// writes the current state to a fresh journal at path and starts the background thread, returns -1 for failure and 0 for success
+	int Start(const std::string &path, const std::unordered_set<DWORD> &seen_ips, const std::unordered_set<std::string> &seen_hosts,
+		      int64_t input_offset, const CrawlStats &crawl_stats);
+
+	// records that every URL before input_offset has been completed, along with the host and IP a URL that just finished
+	// added to the uniqueness sets (empty and 0 for none)
+	void RecordProgress(int64_t input_offset, const CrawlStats &crawl_stats, std::string_view host = std::string_view(), DWORD IP = 0);
+
+	// writes a final snapshot and stops the background thread
+	void Stop();
+};
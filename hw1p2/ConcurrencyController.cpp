@@ -0,0 +1,185 @@
+// ConcurrencyController.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// starts in slow start with INITIAL_CONCURRENCY URLs, or fewer if fewer are allowed
+ConcurrencyController::ConcurrencyController(UINT _max_limit) : max_limit{ _max_limit > 0 ? _max_limit : 1 },
+	in_flight{ 0 }, saturated{ false }, slow_start{ true }, decreases{ 0 }, base_connect_ms{ 0 },
+	last_adjust{ chrono::steady_clock::now() }
+{
+	limit = (INITIAL_CONCURRENCY < max_limit) ? INITIAL_CONCURRENCY : max_limit;
+	for (PhaseStats &stats : phases)
+		stats.history.reserve(LATENCY_HISTORY);
+}
+
+// blocks until a URL may be started
+void ConcurrencyController::Acquire()
+{
+	unique_lock<mutex> guard(lock);
+	slot_freed.wait(guard, [this] { return in_flight < limit; });
+
+	in_flight++;
+	if (in_flight >= limit)
+		saturated = true;
+}
+
+// marks a URL started with Acquire as finished
+void ConcurrencyController::Release()
+{
+	bool grown = false;
+	{
+		lock_guard<mutex> guard(lock);
+		in_flight--;
+
+		if (chrono::steady_clock::now() - last_adjust >= chrono::milliseconds(ADJUST_INTERVAL_MS))
+		{
+			UINT old_limit = limit;
+			Adjust();
+			grown = limit > old_limit;
+		}
+	}
+
+	// one slot was freed, unless the limit also grew there is no point waking more than one of the parked threads
+	if (grown)
+		slot_freed.notify_all();
+	else
+		slot_freed.notify_one();
+}
+
+// reports how long an operation in phase took and whether it timed out (or in the resolver's case, could not be answered)
+void ConcurrencyController::Record(Phase phase, DWORD latency_ms, bool timed_out)
+{
+	lock_guard<mutex> guard(lock);
+	PhaseStats &stats = phases[phase];
+
+	if (timed_out)
+	{
+		stats.timeouts++;
+		return;
+	}
+
+	if (stats.history.size() < LATENCY_HISTORY)
+		stats.history.push_back(latency_ms);
+	else
+		stats.history[stats.next] = latency_ms;
+	stats.next = (stats.next + 1) % LATENCY_HISTORY;
+
+	stats.interval.push_back(latency_ms);
+}
+
+// current timeout for phase in milliseconds
+DWORD ConcurrencyController::Timeout(Phase phase)
+{
+	lock_guard<mutex> guard(lock);
+	return phases[phase].timeout_ms;
+}
+
+// returns the value at fraction p (0 to 1) of the way through samples, which is reordered
+DWORD ConcurrencyController::Percentile(vector<DWORD> &samples, double p)
+{
+	if (samples.empty())
+		return 0;
+
+	auto nth = samples.begin() + (size_t) (p * (samples.size() - 1));
+	nth_element(samples.begin(), nth, samples.end());
+	return *nth;
+}
+
+/*
+ * Function: Adjust
+ * ------------------
+ * Runs at most once per ADJUST_INTERVAL_MS. If enough operations finished since
+ * the last adjustment, the limit is halved when too many of them timed out or
+ * the median connect time has risen more than MAX_LATENCY_RISE times above its
+ * baseline, and otherwise raised if the crawl used the whole limit. Timeouts are
+ * recomputed from each phase's recent history either way. The lock must be held.
+ */
+void ConcurrencyController::Adjust()
+{
+	last_adjust = chrono::steady_clock::now();
+
+	size_t samples = 0, timeouts = 0;
+	for (PhaseStats &stats : phases)
+	{
+		samples += stats.interval.size() + stats.timeouts;
+		timeouts += stats.timeouts;
+	}
+
+	// too little to go on, keep collecting into the same interval
+	if (samples >= MIN_INTERVAL_SAMPLES)
+	{
+		bool congested = timeouts > MAX_TIMEOUT_RATE * samples;
+
+		// rising connect times mean queues are building somewhere between here and the servers
+		PhaseStats &connect = phases[CONNECT];
+		if (connect.interval.size() >= MIN_INTERVAL_SAMPLES)
+		{
+			DWORD median = Percentile(connect.interval, 0.5);
+			if (base_connect_ms == 0 || median <= base_connect_ms)
+				base_connect_ms = (median > 0) ? median : 1;
+			else
+			{
+				if (median > MAX_LATENCY_RISE * base_connect_ms)
+					congested = true;
+
+				// drift up slowly so a lasting change in route is eventually taken as the new baseline
+				base_connect_ms += (median - base_connect_ms) / 16;
+			}
+		}
+
+		if (congested)
+		{
+			limit = (limit > 1) ? limit / 2 : 1;
+			slow_start = false;
+			decreases++;
+		}
+		else if (saturated)
+		{
+			limit = slow_start ? limit * 2 : limit + ADDITIVE_INCREASE;
+			if (limit > max_limit)
+				limit = max_limit;
+		}
+
+		for (PhaseStats &stats : phases)
+		{
+			stats.interval.clear();
+			stats.timeouts = 0;
+		}
+		saturated = (in_flight >= limit);
+	}
+
+	// timeouts leave room for the slow tail without waiting out dead hosts, DNS lookups cannot be given one
+	for (int i = CONNECT; i < NUM_PHASES; i++)
+	{
+		PhaseStats &stats = phases[i];
+		if (stats.history.size() < MIN_INTERVAL_SAMPLES)
+			continue;
+
+		vector<DWORD> history(stats.history);
+		DWORD timeout_ms = Percentile(history, 0.95) * TIMEOUT_MULTIPLIER;
+		stats.timeout_ms = (timeout_ms < MIN_TIMEOUT_MS) ? MIN_TIMEOUT_MS : (timeout_ms > MAX_TIMEOUT_MS) ? MAX_TIMEOUT_MS : timeout_ms;
+	}
+}
+
+// prints the final limit and latencies
+void ConcurrencyController::Print()
+{
+	lock_guard<mutex> guard(lock);
+	const char *names[NUM_PHASES] = { "DNS", "connect", "read" };
+
+	printf("\tconcurrency limit %u of %u (cut %u times)\n", limit, max_limit, decreases);
+	for (int i = 0; i < NUM_PHASES; i++)
+	{
+		vector<DWORD> history(phases[i].history);
+		printf("\t%s latency p50 %lu ms, p95 %lu ms", names[i], (unsigned long) Percentile(history, 0.5),
+		       (unsigned long) Percentile(history, 0.95));
+		if (i != DNS)
+			printf(", timeout %lu ms", (unsigned long) phases[i].timeout_ms);
+		printf("\n");
+	}
+}
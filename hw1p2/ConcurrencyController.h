@@ -0,0 +1,105 @@
+// ConcurrencyController.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// number of URLs in flight when a crawl starts, if that many threads are available
+const UINT INITIAL_CONCURRENCY = 8;
+
+// URLs added to the limit each interval once slow start has ended
+const UINT ADDITIVE_INCREASE = 4;
+
+// time between adjustments of the limit and timeouts
+const UINT ADJUST_INTERVAL_MS = 1000;
+
+// fewest samples in an interval for it to be used to adjust the limit
+const UINT MIN_INTERVAL_SAMPLES = 20;
+
+// fraction of operations in an interval that may time out before the limit is cut
+const double MAX_TIMEOUT_RATE = 0.1;
+
+// factor the median connect time may rise above its lowest value before the limit is cut
+const double MAX_LATENCY_RISE = 2.0;
+
+// latencies kept per phase for computing percentiles
+const size_t LATENCY_HISTORY = 512;
+
+// timeouts are this multiple of the 95th percentile latency, within the bounds below
+const UINT TIMEOUT_MULTIPLIER = 4;
+const UINT MIN_TIMEOUT_MS = 1000;
+const UINT MAX_TIMEOUT_MS = TIMEOUT_SECONDS * 1000;
+
+/*
+ * Decides how many URLs are crawled at once and how long each network phase
+ * may take, from what the crawler threads observe. Threads take a slot with
+ * Acquire before each URL and return it with Release, and report the latency
+ * and outcome of every DNS lookup, connect and read with Record.
+ *
+ * The limit follows AIMD. It doubles every interval until the first sign of
+ * congestion (slow start), after which it grows by ADDITIVE_INCREASE per
+ * interval while the crawl is using all of it, and is halved whenever too many
+ * operations time out or the median connect time rises well above the lowest
+ * seen, which is how an overloaded local link, port range or resolver shows up.
+ * Connect and read timeouts track a multiple of their phase's 95th percentile,
+ * so a crawl of fast hosts stops waiting the full TIMEOUT_SECONDS on dead ones.
+ * DNS lookups go through gethostbyname, which has no timeout, so their latency
+ * and failures only feed the limit and no DNS timeout is kept.
+ */
+class ConcurrencyController
+{
+public:
+	enum Phase { DNS, CONNECT, READ, NUM_PHASES };
+
+private:
+	struct PhaseStats
+	{
+		std::vector<DWORD> history;  // last LATENCY_HISTORY latencies, a ring buffer
+		size_t next;                 // where the next latency goes in history
+		std::vector<DWORD> interval; // latencies since the last adjustment
+		UINT timeouts;               // timeouts since the last adjustment
+		DWORD timeout_ms;
+
+		PhaseStats() : next{ 0 }, timeouts{ 0 }, timeout_ms{ MAX_TIMEOUT_MS } {}
+	};
+
+	std::mutex lock;
+	std::condition_variable slot_freed;
+
+	UINT max_limit;
+	UINT limit;
+	UINT in_flight;
+	bool saturated;  // in_flight reached limit during this interval
+	bool slow_start;
+	UINT decreases;
+
+	PhaseStats phases[NUM_PHASES];
+	DWORD base_connect_ms; // lowest median connect time over any interval, 0 until known
+	std::chrono::steady_clock::time_point last_adjust;
+
+	// returns the value at fraction p (0 to 1) of the way through samples, which is reordered
+	static DWORD Percentile(std::vector<DWORD> &samples, double p);
+
+	// updates the limit and timeouts from the samples of the last interval, lock must be held
+	void Adjust();
+
+public:
+	// limits concurrency to at most _max_limit URLs
+	explicit ConcurrencyController(UINT _max_limit);
+
+	// blocks until a URL may be started
+	void Acquire();
+
+	// marks a URL started with Acquire as finished
+	void Release();
+
+	// reports how long an operation in phase took and whether it timed out (or in the resolver's case, could not be answered)
+	void Record(Phase phase, DWORD latency_ms, bool timed_out);
+
+	// current timeout in milliseconds for phase, which is CONNECT or READ
+	DWORD Timeout(Phase phase);
+
+	// prints the final limit and latencies
+	void Print();
+};
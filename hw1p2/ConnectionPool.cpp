@@ -0,0 +1,125 @@
+// ConnectionPool.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// closes all idle connections
+ConnectionPool::~ConnectionPool()
+{
+	for (auto &host : hosts)
+	{
+		for (IdleConnection &conn : host.second.idle)
+			closesocket(conn.sock);
+	}
+}
+
+/*
+ * Function: Checkout
+ * ------------------
+ * Reserves one of the host's connection slots and looks for an idle connection
+ * to hand back with it. Idle connections that have expired or fail the health
+ * check are closed along the way.
+ *
+ * input:
+ *   - key: "<host>:<port>" of the server to connect to
+ *
+ * return: a connected socket that can be written to immediately, or
+ *         INVALID_SOCKET if the caller must open a new connection
+ */
+SOCKET ConnectionPool::Checkout(const string &key)
+{
+	unique_lock<mutex> guard(lock);
+
+	// evict at most once a second so the scan stays cheap
+	auto now = chrono::steady_clock::now();
+	if (now - last_eviction >= chrono::seconds(1))
+	{
+		EvictIdle();
+		last_eviction = now;
+	}
+
+	// waiting keeps the entry from being evicted while the lock is released
+	HostEntry &host = hosts[key];
+	host.waiting++;
+	slot_freed.wait(guard, [&host] { return host.active < MAX_CONNECTIONS_PER_HOST; });
+	host.waiting--;
+	host.active++;
+
+	// most recently used connection is the most likely to still be open
+	while (!host.idle.empty())
+	{
+		IdleConnection conn = host.idle.back();
+		host.idle.pop_back();
+
+		if (now - conn.since < chrono::seconds(MAX_IDLE_SECONDS) && Healthy(conn.sock))
+			return conn.sock;
+
+		closesocket(conn.sock);
+	}
+
+	return INVALID_SOCKET;
+}
+
+// frees the slot for key, keeping sock for reuse if reusable and closing it otherwise
+void ConnectionPool::Release(const string &key, SOCKET sock, bool reusable)
+{
+	{
+		lock_guard<mutex> guard(lock);
+		HostEntry &host = hosts[key];
+		host.active--;
+
+		if (sock != INVALID_SOCKET)
+		{
+			if (reusable && host.idle.size() < MAX_IDLE_PER_HOST)
+				host.idle.push_back({ sock, chrono::steady_clock::now() });
+			else
+				closesocket(sock);
+		}
+	}
+
+	// waiters may be for any host, so wake all of them to recheck
+	slot_freed.notify_all();
+}
+
+// true if an idle socket has not been closed by the server and has no unexpected data waiting
+bool ConnectionPool::Healthy(SOCKET sock)
+{
+	fd_set fd;
+	FD_ZERO(&fd);
+	FD_SET(sock, &fd);
+	struct timeval no_wait = { 0, 0 };
+
+	// an idle connection should have nothing to read, if it is readable the server
+	// has closed or reset it, or sent data that does not belong to any request
+	return select((int) sock + 1, &fd, NULL, NULL, &no_wait) == 0;
+}
+
+// closes connections idle longer than MAX_IDLE_SECONDS, lock must be held
+void ConnectionPool::EvictIdle()
+{
+	auto now = chrono::steady_clock::now();
+
+	for (auto it = hosts.begin(); it != hosts.end(); )
+	{
+		vector<IdleConnection> &idle = it->second.idle;
+		auto expired = remove_if(idle.begin(), idle.end(), [now](const IdleConnection &conn)
+		{
+			if (now - conn.since < chrono::seconds(MAX_IDLE_SECONDS))
+				return false;
+
+			closesocket(conn.sock);
+			return true;
+		});
+		idle.erase(expired, idle.end());
+
+		// drop hosts with nothing left to track
+		if (idle.empty() && it->second.active == 0 && it->second.waiting == 0)
+			it = hosts.erase(it);
+		else
+			++it;
+	}
+}
@@ -0,0 +1,63 @@
+// ConnectionPool.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// most connections that may be open to a single host at once
+const UINT MAX_CONNECTIONS_PER_HOST = 2;
+
+// most idle connections kept for a single host
+const UINT MAX_IDLE_PER_HOST = 2;
+
+// idle connections older than this are closed rather than reused
+const UINT MAX_IDLE_SECONDS = 15;
+
+/*
+ * Pool of idle keep-alive connections keyed by "<host>:<port>", shared by all
+ * crawler threads. Checking out a connection also reserves one of the host's
+ * MAX_CONNECTIONS_PER_HOST slots, which is held until the connection is
+ * released, so callers block instead of opening more connections to a host.
+ */
+class ConnectionPool
+{
+	struct IdleConnection
+	{
+		SOCKET sock;
+		std::chrono::steady_clock::time_point since;
+	};
+
+	struct HostEntry
+	{
+		std::vector<IdleConnection> idle;
+		UINT active;  // checked out slots
+		UINT waiting; // threads blocked waiting for a slot
+
+		HostEntry() : active{ 0 }, waiting{ 0 } {}
+	};
+
+	std::mutex lock;
+	std::condition_variable slot_freed;
+	std::unordered_map<std::string, HostEntry> hosts;
+	std::chrono::steady_clock::time_point last_eviction;
+
+	// true if an idle socket has not been closed by the server and has no unexpected data waiting
+	static bool Healthy(SOCKET sock);
+
+	// closes connections idle longer than MAX_IDLE_SECONDS, lock must be held
+	void EvictIdle();
+
+public:
+	ConnectionPool() : last_eviction{ std::chrono::steady_clock::now() } {}
+
+	// closes all idle connections
+	~ConnectionPool();
+
+	// reserves a slot for key (waiting for one if the host is at its limit) and returns a healthy idle connection,
+	// or INVALID_SOCKET if the caller must open a new one
+	SOCKET Checkout(const std::string &key);
+
+	// frees the slot for key, keeping sock for reuse if reusable and closing it otherwise
+	void Release(const std::string &key, SOCKET sock, bool reusable);
+};
@@ -0,0 +1,366 @@
+// Coordinator.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// sets up an empty shard for each worker
+Coordinator::Coordinator(const string &_input_path, unsigned num_shards) : input_path{ _input_path }, shards(num_shards) {}
+
+// waits for any threads still running and closes every handle
+Coordinator::~Coordinator()
+{
+	for (Shard &shard : shards)
+	{
+		if (shard.input != NULL)
+			CloseHandle(shard.input);
+		if (shard.feeder.joinable())
+			shard.feeder.join();
+		if (shard.collector.joinable())
+			shard.collector.join();
+		if (shard.output != NULL)
+			CloseHandle(shard.output);
+		if (shard.process != NULL)
+			CloseHandle(shard.process);
+	}
+}
+
+/*
+ * Function: ShardOf
+ * ------------------
+ * Hashes host (ignoring case) with 64-bit FNV-1a and maps the hash to a shard
+ * with Lamping and Veach's jump consistent hash, which spreads hosts evenly
+ * and moves only 1/n of them when the number of shards changes.
+ *
+ * input:
+ *   - host: host name of a URL, may be empty
+ *   - num_shards: number of shards, at least 1
+ *
+ * return: the shard in [0, num_shards) that owns host
+ */
+unsigned Coordinator::ShardOf(string_view host, unsigned num_shards)
+{
+	uint64_t key = 14695981039346656037ULL;
+	for (char c : host)
+	{
+		key ^= (uint8_t) tolower((unsigned char) c);
+		key *= 1099511628211ULL;
+	}
+
+	int64_t bucket = -1, next = 0;
+	while (next < (int64_t) num_shards)
+	{
+		bucket = next;
+		key = key * 2862933555777941757ULL + 1;
+		next = (int64_t) ((bucket + 1) * ((double) (1LL << 31) / (double) ((key >> 33) + 1)));
+	}
+
+	return (unsigned) bucket;
+}
+
+/*
+ * Function: Run
+ * ------------------
+ * Starts a worker for every shard, then reads the input file on this thread,
+ * handing each worker its share through a feeder thread, and prints each
+ * worker's output on a collector thread. Returns once every worker has
+ * exited.
+ *
+ * input:
+ *   - num_threads, num_parse_threads: thread counts passed on to each worker
+ *   - archive_dir: directory passed on to each worker to archive pages to, empty for none
+ *   - insecure: passed on to each worker to accept any server certificate
+ * output:
+ *   - stats: the totals reported by every worker are added to it
+ *
+ * return: -1 if a worker could not be started or exited without reporting its
+ *         totals, 0 otherwise
+ */
+int Coordinator::Run(int num_threads, unsigned num_parse_threads, const string &archive_dir, bool insecure, CrawlStats &stats)
+{
+	// workers run this same executable
+	char exe_path[MAX_PATH];
+	DWORD len = GetModuleFileNameA(NULL, exe_path, MAX_PATH);
+	if (len == 0 || len >= MAX_PATH)
+	{
+		printf("GetModuleFileName generated error %lu\n", (unsigned long) GetLastError());
+		return -1;
+	}
+
+	// every worker is started before any pipe is handed to a thread, so no worker inherits another's pipe
+	for (unsigned i = 0; i < shards.size(); i++)
+	{
+		if (Spawn(i, exe_path, num_threads, num_parse_threads, archive_dir, insecure) < 0)
+			return -1;
+	}
+
+	for (unsigned i = 0; i < shards.size(); i++)
+	{
+		shards[i].feeder = thread(&Coordinator::Feed, this, i);
+		shards[i].collector = thread(&Coordinator::Collect, this, i);
+	}
+
+	Split();
+
+	int ret = 0;
+	for (unsigned i = 0; i < shards.size(); i++)
+	{
+		Shard &shard = shards[i];
+		shard.feeder.join();
+		shard.collector.join();
+		WaitForSingleObject(shard.process, INFINITE);
+
+		DWORD exit_code = 0;
+		GetExitCodeProcess(shard.process, &exit_code);
+		if (exit_code != 0 || !shard.reported)
+		{
+			printf("shard %u worker failed with exit code %lu\n", i, (unsigned long) exit_code);
+			ret = -1;
+		}
+
+		// keep whatever a failed worker managed to report
+		stats += shard.stats;
+	}
+
+	return ret;
+}
+
+// starts the worker process for shard index with pipes for its stdin and stdout, returns -1 for failure and 0 for success
+int Coordinator::Spawn(unsigned index, const char *exe_path, int num_threads, unsigned num_parse_threads, const string &archive_dir, bool insecure)
+{
+	Shard &shard = shards[index];
+	SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+	HANDLE child_input = NULL, child_output = NULL;
+
+	// the worker gets one end of each pipe, the coordinator's ends must not be inherited
+	if (!CreatePipe(&child_input, &shard.input, &inherit, SHARD_PIPE_SIZE))
+	{
+		printf("CreatePipe generated error %lu\n", (unsigned long) GetLastError());
+		return -1;
+	}
+	if (!CreatePipe(&shard.output, &child_output, &inherit, SHARD_PIPE_SIZE))
+	{
+		printf("CreatePipe generated error %lu\n", (unsigned long) GetLastError());
+		CloseHandle(child_input);
+		return -1;
+	}
+	SetHandleInformation(shard.input, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(shard.output, HANDLE_FLAG_INHERIT, 0);
+
+	// "<exe>" <threads> "<input>" --shard-worker <index> [--parse-threads <N>] [--archive "<dir>"] [--insecure]
+	string command = string("\"") + exe_path + "\" " + to_string(num_threads) + " \"" + input_path + "\" " +
+	                 SHARD_WORKER_OPTION + " " + to_string(index);
+	if (num_parse_threads > 0)
+		command += " --parse-threads " + to_string(num_parse_threads);
+	if (!archive_dir.empty())
+		command += " --archive \"" + archive_dir + "\"";
+	if (insecure)
+		command += " --insecure";
+	vector<char> command_line(command.begin(), command.end());
+	command_line.push_back('\0');
+
+	STARTUPINFOA startup = { 0 };
+	startup.cb = sizeof(startup);
+	startup.dwFlags = STARTF_USESTDHANDLES;
+	startup.hStdInput = child_input;
+	startup.hStdOutput = child_output;
+	startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	PROCESS_INFORMATION info = { 0 };
+	BOOL created = CreateProcessA(NULL, command_line.data(), NULL, NULL, TRUE, 0, NULL, NULL, &startup, &info);
+
+	// the worker holds its own copies now, so the pipes close when it exits
+	CloseHandle(child_input);
+	CloseHandle(child_output);
+
+	if (!created)
+	{
+		printf("CreateProcess generated error %lu\n", (unsigned long) GetLastError());
+		return -1;
+	}
+
+	CloseHandle(info.hThread);
+	shard.process = info.hProcess;
+	return 0;
+}
+
+/*
+ * Function: Split
+ * ------------------
+ * Reads the input file once, hashing the host of each line to find its shard
+ * and gathering the line into that shard's batch. A batch is queued for the
+ * shard's feeder once it reaches SHARD_PIPE_SIZE bytes, and whatever is left
+ * is queued at the end of the file. Every shard is then marked done, which
+ * tells its feeder to close the pipe once the queue is empty.
+ */
+void Coordinator::Split()
+{
+	FILE *file = NULL;
+	char *line = (char*) malloc(MAX_URL_LEN);
+	vector<string> pending(shards.size());
+
+	if (line == NULL)
+		printf("malloc failed for shard input\n");
+	else if (fopen_s(&file, input_path.c_str(), "rb") != 0 || file == NULL)
+		printf("%s could not be opened for reading by the coordinator\n", input_path.c_str());
+	else
+	{
+		// lines longer than the buffer arrive in pieces, which all go to the shard of the first
+		bool line_start = true;
+		unsigned index = 0;
+		while (fgets(line, MAX_URL_LEN, file) != NULL)
+		{
+			if (line_start)
+				index = ShardOf(ParsedURL::ExtractHost(line), (unsigned) shards.size());
+
+			size_t len = strlen(line);
+			line_start = (len > 0 && line[len - 1] == '\n');
+
+			pending[index].append(line, len);
+			if (pending[index].size() >= SHARD_PIPE_SIZE)
+				Queue(index, pending[index]);
+		}
+
+		fclose(file);
+	}
+
+	free(line);
+
+	for (unsigned i = 0; i < shards.size(); i++)
+	{
+		if (!pending[i].empty())
+			Queue(i, pending[i]);
+
+		{
+			lock_guard<mutex> guard(shards[i].lock);
+			shards[i].done = true;
+		}
+		shards[i].changed.notify_all();
+	}
+}
+
+// queues a batch of lines for shard index, waiting while MAX_QUEUED_BATCHES are already queued
+void Coordinator::Queue(unsigned index, string &batch)
+{
+	Shard &shard = shards[index];
+	{
+		unique_lock<mutex> guard(shard.lock);
+		shard.changed.wait(guard, [&shard] { return shard.batches.size() < MAX_QUEUED_BATCHES || shard.gone; });
+		if (!shard.gone)
+			shard.batches.push_back(move(batch));
+	}
+	shard.changed.notify_all();
+
+	batch.clear();
+	batch.reserve(SHARD_PIPE_SIZE);
+}
+
+/*
+ * Function: Feed
+ * ------------------
+ * Writes the batches Split queues for shard index to its worker's stdin. If
+ * the worker stops reading, the rest of its batches are dropped so the reader
+ * is never left waiting on it. Closing the pipe at the end tells the worker
+ * there are no more URLs.
+ *
+ * input:
+ *   - index: shard to feed
+ */
+void Coordinator::Feed(unsigned index)
+{
+	Shard &shard = shards[index];
+	string batch;
+
+	for (;;)
+	{
+		{
+			unique_lock<mutex> guard(shard.lock);
+			shard.changed.wait(guard, [&shard] { return !shard.batches.empty() || shard.done; });
+			if (shard.batches.empty())
+				break;
+
+			batch = move(shard.batches.front());
+			shard.batches.pop_front();
+		}
+		shard.changed.notify_all();
+
+		const char *pos = batch.data();
+		size_t left = batch.size();
+		while (left > 0)
+		{
+			DWORD written = 0;
+			if (!WriteFile(shard.input, pos, (DWORD) left, &written, NULL))
+				break;
+
+			pos += written;
+			left -= written;
+		}
+
+		// worker is gone, drop whatever is queued or still to come
+		if (left > 0)
+		{
+			{
+				lock_guard<mutex> guard(shard.lock);
+				shard.gone = true;
+				shard.batches.clear();
+			}
+			shard.changed.notify_all();
+			break;
+		}
+	}
+
+	CloseHandle(shard.input);
+	shard.input = NULL;
+}
+
+/*
+ * Function: Collect
+ * ------------------
+ * Reads the worker's stdout until it closes, printing each complete line with
+ * the shard number in front. The totals line printed by the worker at exit is
+ * kept instead of printed.
+ *
+ * input:
+ *   - index: shard to collect output from
+ */
+void Coordinator::Collect(unsigned index)
+{
+	Shard &shard = shards[index];
+	char chunk[4096];
+	string pending;
+	DWORD bytes = 0;
+
+	// a failed read means the worker closed its end
+	bool open = true;
+	while (open)
+	{
+		open = ReadFile(shard.output, chunk, sizeof(chunk), &bytes, NULL) && bytes > 0;
+		if (open)
+			pending.append(chunk, bytes);
+		else if (!pending.empty() && pending.back() != '\n')
+			pending.push_back('\n');
+
+		size_t line_start = 0, line_end;
+		while ((line_end = pending.find('\n', line_start)) != string::npos)
+		{
+			pending[line_end] = '\0';
+			if (line_end > line_start && pending[line_end - 1] == '\r')
+				pending[line_end - 1] = '\0';
+
+			const char *text = pending.c_str() + line_start;
+			if (shard.stats.ParseReport(text))
+				shard.reported = true;
+			else
+			{
+				lock_guard<mutex> guard(print_lock);
+				printf("[%u] %s\n", index, text);
+			}
+
+			line_start = line_end + 1;
+		}
+		pending.erase(0, line_start);
+	}
+}
@@ -0,0 +1,86 @@
+// Coordinator.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// largest number of worker processes a coordinator will start
+const unsigned MAX_NUM_SHARDS = 64;
+
+// size of the pipes between the coordinator and each worker
+const DWORD SHARD_PIPE_SIZE = 64 * 1024;
+
+// most batches of SHARD_PIPE_SIZE bytes read for a shard before the input file reader waits for its worker
+const size_t MAX_QUEUED_BATCHES = 16;
+
+// command line option that starts a process as a worker for one shard
+const char SHARD_WORKER_OPTION[] = "--shard-worker";
+
+/*
+ * Splits a crawl across worker processes by host. Every seed URL goes to the
+ * shard picked by a jump consistent hash of its host, so all URLs for a host
+ * land in the same worker and that worker alone makes the host's uniqueness
+ * and robots decisions. Workers are copies of this executable started with
+ * SHARD_WORKER_OPTION, reading their URLs from stdin. The input file is read
+ * once, and each shard's lines are queued in batches for a feeder thread that
+ * writes them to its worker, so a slow worker only holds up the reader once
+ * MAX_QUEUED_BATCHES of its batches are waiting. Their output comes back
+ * over stdout and is printed with the shard number in front of each line, and
+ * the totals each worker reports on exit are added together.
+ *
+ * IP uniqueness is only checked within a shard, so two hosts on the same IP
+ * that hash to different shards are both crawled.
+ */
+class Coordinator
+{
+	struct Shard
+	{
+		HANDLE process;
+		HANDLE input;  // write end of the worker's stdin
+		HANDLE output; // read end of the worker's stdout
+		std::thread feeder, collector;
+		CrawlStats stats;
+		bool reported; // worker printed its totals before exiting
+
+		// batches of lines read for the worker but not yet written to it, guarded by lock
+		std::mutex lock;
+		std::condition_variable changed;
+		std::deque<std::string> batches;
+		bool done; // every batch has been queued
+		bool gone; // worker stopped reading, so later batches are dropped
+
+		Shard() : process{ NULL }, input{ NULL }, output{ NULL }, reported{ false }, done{ false }, gone{ false } {}
+	};
+
+	std::string input_path;
+	std::vector<Shard> shards;
+
+	// keeps lines from different workers from mixing on stdout
+	std::mutex print_lock;
+
+	// starts the worker process for shard index with pipes for its stdin and stdout, returns -1 for failure and 0 for success
+	int Spawn(unsigned index, const char *exe_path, int num_threads, unsigned num_parse_threads, const std::string &archive_dir, bool insecure);
+
+	// reads the input file once, queueing each line for the shard that owns its host
+	void Split();
+
+	// queues a batch of lines for shard index, waiting while MAX_QUEUED_BATCHES are already queued
+	void Queue(unsigned index, std::string &batch);
+
+	// writes the batches queued for shard index to its worker, then closes the pipe
+	void Feed(unsigned index);
+
+	// prints the worker's output for shard index until it exits, keeping the totals it reports
+	void Collect(unsigned index);
+
+public:
+	Coordinator(const std::string &_input_path, unsigned num_shards);
+	~Coordinator();
+
+	// returns the shard in [0, num_shards) that owns host
+	static unsigned ShardOf(std::string_view host, unsigned num_shards);
+
+	// crawls the input file with a worker per shard and adds their totals to stats, returns -1 if any worker failed and 0 otherwise
+	int Run(int num_threads, unsigned num_parse_threads, const std::string &archive_dir, bool insecure, CrawlStats &stats);
+};
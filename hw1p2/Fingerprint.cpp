@@ -0,0 +1,253 @@
+// Fingerprint.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// xxHash64 primes
+const uint64_t PRIME_1 = 11400714785074694791ULL;
+const uint64_t PRIME_2 = 14029467366897019727ULL;
+const uint64_t PRIME_3 = 1609587929392839161ULL;
+const uint64_t PRIME_4 = 9650029242287828579ULL;
+const uint64_t PRIME_5 = 2870177450012600261ULL;
+
+// FNV-1a parameters for words
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static inline uint64_t RotateLeft(uint64_t x, int bits)
+{
+	return (x << bits) | (x >> (64 - bits));
+}
+
+// mixes 8 bytes of input into one lane
+static inline uint64_t Round(uint64_t lane, uint64_t input)
+{
+	lane += input * PRIME_2;
+	lane = RotateLeft(lane, 31);
+	return lane * PRIME_1;
+}
+
+// spreads every input bit over the whole result
+static inline uint64_t Avalanche(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+// number of set bits in x
+static inline unsigned PopCount(uint64_t x)
+{
+	unsigned count = 0;
+	for (; x != 0; x &= x - 1)
+		count++;
+	return count;
+}
+
+// clears all state for a new body
+void ContentHasher::Reset()
+{
+	lanes[0] = PRIME_1 + PRIME_2;
+	lanes[1] = PRIME_2;
+	lanes[2] = 0;
+	lanes[3] = 0 - PRIME_1;
+	stripe_len = 0;
+	total_len = 0;
+
+	memset(bit_counts, 0, sizeof(bit_counts));
+	num_words = 0;
+	word = FNV_OFFSET;
+	in_word = false;
+	in_tag = false;
+	shingles = 0;
+}
+
+// hashes a full 32-byte stripe into the lanes
+void ContentHasher::ConsumeStripe(const char *data)
+{
+	uint64_t input[4];
+	memcpy(input, data, sizeof(input));
+
+	// independent lanes, the compiler is free to interleave or vectorize them
+	for (int i = 0; i < 4; i++)
+		lanes[i] = Round(lanes[i], input[i]);
+}
+
+// finishes the current word and adds the shingle ending with it
+void ContentHasher::EndWord()
+{
+	in_word = false;
+
+	memmove(words, words + 1, (SHINGLE_WORDS - 1) * sizeof(uint64_t));
+	words[SHINGLE_WORDS - 1] = word;
+	word = FNV_OFFSET;
+
+	if (++num_words < SHINGLE_WORDS)
+		return;
+
+	// order matters within a shingle, so each word is rotated by its position
+	uint64_t shingle = 0;
+	for (unsigned i = 0; i < SHINGLE_WORDS; i++)
+		shingle ^= RotateLeft(words[i], (int) (i * 17 + 1));
+	shingle = Avalanche(shingle);
+
+	for (int bit = 0; bit < 64; bit++)
+		bit_counts[bit] += ((shingle >> bit) & 1) ? 1 : -1;
+	shingles++;
+}
+
+/*
+ * Function: Feed
+ * ------------------
+ * Hashes the next chunk of the body. Whole stripes are hashed straight from
+ * chunk, and only the bytes of a stripe split between chunks are copied. The
+ * SimHash is updated a byte at a time, keeping the word being read across
+ * chunk boundaries.
+ *
+ * input:
+ *   - chunk: next bytes of the body
+ *   - size: number of bytes in chunk
+ */
+void ContentHasher::Feed(const char *chunk, size_t size)
+{
+	total_len += size;
+
+	// exact hash
+	const char *pos = chunk, *end = chunk + size;
+	if (stripe_len > 0)
+	{
+		size_t fill = sizeof(stripe) - stripe_len;
+		if (fill > size)
+			fill = size;
+
+		memcpy(stripe + stripe_len, pos, fill);
+		stripe_len += fill;
+		pos += fill;
+
+		if (stripe_len == sizeof(stripe))
+		{
+			ConsumeStripe(stripe);
+			stripe_len = 0;
+		}
+	}
+	for (; end - pos >= (ptrdiff_t) sizeof(stripe); pos += sizeof(stripe))
+		ConsumeStripe(pos);
+	if (pos < end)
+	{
+		memcpy(stripe + stripe_len, pos, end - pos);
+		stripe_len += end - pos;
+	}
+
+	// SimHash over the words outside of tags
+	for (size_t i = 0; i < size; i++)
+	{
+		unsigned char c = (unsigned char) chunk[i];
+		if (in_tag)
+		{
+			if (c == '>')
+				in_tag = false;
+		}
+		else if (isalnum(c))
+		{
+			word = (word ^ (uint64_t) tolower(c)) * FNV_PRIME;
+			in_word = true;
+		}
+		else
+		{
+			if (in_word)
+				EndWord();
+			if (c == '<')
+				in_tag = true;
+		}
+	}
+}
+
+// returns the fingerprint of everything fed since the last reset
+PageFingerprint ContentHasher::Finish()
+{
+	PageFingerprint fingerprint;
+
+	// exact hash, merging the lanes and then the bytes that never made up a full stripe
+	uint64_t hash;
+	if (total_len >= sizeof(stripe))
+	{
+		hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+		for (int i = 0; i < 4; i++)
+			hash = (hash ^ Round(0, lanes[i])) * PRIME_1 + PRIME_4;
+	}
+	else
+		hash = PRIME_5;
+	hash += total_len;
+
+	size_t i = 0;
+	for (; i + 8 <= stripe_len; i += 8)
+	{
+		uint64_t input;
+		memcpy(&input, stripe + i, sizeof(input));
+		hash = RotateLeft(hash ^ Round(0, input), 27) * PRIME_1 + PRIME_4;
+	}
+	for (; i < stripe_len; i++)
+		hash = RotateLeft(hash ^ ((unsigned char) stripe[i] * PRIME_5), 11) * PRIME_1;
+	fingerprint.exact = Avalanche(hash);
+
+	// SimHash, each bit set if more shingles had it set than not
+	if (in_word)
+		EndWord();
+	for (int bit = 0; bit < 64; bit++)
+	{
+		if (bit_counts[bit] > 0)
+			fingerprint.simhash |= 1ULL << bit;
+	}
+	fingerprint.shingles = shingles;
+
+	return fingerprint;
+}
+
+/*
+ * Function: Insert
+ * ------------------
+ * Checks fingerprint against every page seen so far and adds it to the index
+ * if it is unique. Pages too short for a meaningful SimHash are only checked
+ * for exact duplicates.
+ *
+ * input:
+ *   - fingerprint: fingerprint of a page that was just downloaded
+ *
+ * return: EXACT if an identical page was seen, NEAR if a page within
+ *         MAX_SIMHASH_DISTANCE bits was seen, or UNIQUE otherwise
+ */
+FingerprintIndex::Match FingerprintIndex::Insert(const PageFingerprint &fingerprint)
+{
+	lock_guard<mutex> guard(lock);
+
+	if (!exact.insert(fingerprint.exact).second)
+		return Match::EXACT;
+
+	if (fingerprint.shingles < MIN_SHINGLES)
+		return Match::UNIQUE;
+
+	for (uint32_t band = 0; band < SIMHASH_BANDS; band++)
+	{
+		auto bucket = bands.find((band << 16) | (uint32_t) ((fingerprint.simhash >> (16 * band)) & 0xFFFF));
+		if (bucket == bands.end())
+			continue;
+
+		for (uint64_t simhash : bucket->second)
+		{
+			if (PopCount(simhash ^ fingerprint.simhash) <= MAX_SIMHASH_DISTANCE)
+				return Match::NEAR;
+		}
+	}
+
+	for (uint32_t band = 0; band < SIMHASH_BANDS; band++)
+		bands[(band << 16) | (uint32_t) ((fingerprint.simhash >> (16 * band)) & 0xFFFF)].push_back(fingerprint.simhash);
+
+	return Match::UNIQUE;
+}
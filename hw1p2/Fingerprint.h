@@ -0,0 +1,94 @@
+// Fingerprint.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// number of consecutive words hashed together into one SimHash shingle
+const unsigned SHINGLE_WORDS = 4;
+
+// pages with fewer shingles than this are too short for near-duplicate checks
+const unsigned MIN_SHINGLES = 16;
+
+// largest number of differing SimHash bits for two pages to count as near duplicates,
+// must be less than SIMHASH_BANDS so that near duplicates always share a band
+const unsigned MAX_SIMHASH_DISTANCE = 3;
+
+// number of 16-bit bands a SimHash is split into for indexing
+const unsigned SIMHASH_BANDS = 4;
+
+// fingerprint of a page body
+struct PageFingerprint
+{
+	uint64_t exact;    // hash of every byte, equal only for identical bodies
+	uint64_t simhash;  // SimHash of the text, differs in few bits for similar bodies
+	uint32_t shingles; // number of shingles in simhash
+
+	PageFingerprint() : exact{ 0 }, simhash{ 0 }, shingles{ 0 } {}
+};
+
+/*
+ * Computes a PageFingerprint over a body fed in arbitrary chunks, so it can be
+ * done while the page downloads. The exact hash runs four independent 64-bit
+ * lanes over 32-byte stripes (in the style of xxHash64), which keeps several
+ * multiplies in flight at once instead of one long dependency chain. The SimHash
+ * covers shingles of SHINGLE_WORDS words of text outside of tags, with letters
+ * and digits lower cased, so markup and case changes do not affect it.
+ */
+class ContentHasher
+{
+	uint64_t lanes[4];
+	char stripe[32];    // bytes not yet making up a full stripe
+	size_t stripe_len;
+	uint64_t total_len;
+
+	// SimHash state
+	int32_t bit_counts[64];
+	uint64_t words[SHINGLE_WORDS]; // hashes of the last few words, oldest first
+	uint32_t num_words;
+	uint64_t word;                 // hash of the word being read
+	bool in_word;
+	bool in_tag;
+	uint32_t shingles;
+
+	// hashes a full 32-byte stripe into the lanes
+	void ConsumeStripe(const char *data);
+
+	// finishes the current word and adds the shingle ending with it
+	void EndWord();
+
+public:
+	ContentHasher() { Reset(); }
+
+	// clears all state for a new body
+	void Reset();
+
+	// hashes the next chunk of the body
+	void Feed(const char *chunk, size_t size);
+
+	// returns the fingerprint of everything fed since the last reset
+	PageFingerprint Finish();
+};
+
+/*
+ * Set of fingerprints of pages already crawled, safe to share between threads.
+ * Exact hashes are kept in a hash set. SimHashes are indexed by each of their
+ * SIMHASH_BANDS 16-bit bands, and two hashes within MAX_SIMHASH_DISTANCE bits
+ * always share at least one band, so only hashes in a matching band bucket have
+ * to be compared.
+ */
+class FingerprintIndex
+{
+	std::mutex lock;
+	std::unordered_set<uint64_t> exact;
+
+	// band number in the high 16 bits, band value in the low 16 bits
+	std::unordered_map<uint32_t, std::vector<uint64_t>> bands;
+
+public:
+	enum class Match { UNIQUE, EXACT, NEAR };
+
+	// looks fingerprint up and adds it if it is unique, returns how it matched
+	Match Insert(const PageFingerprint &fingerprint);
+};
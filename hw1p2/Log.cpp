@@ -0,0 +1,45 @@
+// Log.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// buffer for the calling thread's output, so that with several crawler threads
+// each URL's trace can be printed in one piece once it is complete
+static thread_local string *log_buffer = nullptr;
+
+// prints like printf, or appends to the calling thread's log buffer while one is set
+void Log(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	if (log_buffer == nullptr)
+		vprintf(format, args);
+	else
+	{
+		va_list size_args;
+		va_copy(size_args, args);
+		int len = vsnprintf(NULL, 0, format, size_args);
+		va_end(size_args);
+
+		if (len > 0)
+		{
+			size_t old_size = log_buffer->size();
+			log_buffer->resize(old_size + len + 1);
+			vsnprintf(&(*log_buffer)[old_size], len + 1, format, args);
+			log_buffer->resize(old_size + len);
+		}
+	}
+
+	va_end(args);
+}
+
+// sets the buffer Log appends to on the calling thread, nullptr to print directly
+void SetLogBuffer(string *buffer)
+{
+	log_buffer = buffer;
+}
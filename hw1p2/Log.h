@@ -0,0 +1,12 @@
+// Log.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// prints like printf, or appends to the calling thread's log buffer while one is set
+void Log(const char *format, ...);
+
+// sets the buffer Log appends to on the calling thread, nullptr to print directly
+void SetLogBuffer(std::string *buffer);
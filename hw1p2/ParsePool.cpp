@@ -0,0 +1,112 @@
+// ParsePool.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// creates the semaphores and starts num_threads parse threads
+ParsePool::ParsePool(unsigned num_threads, function<void(ParseJob&)> _done) : queue{ PARSE_QUEUE_SIZE }, done{ _done }
+{
+	free_slots = CreateSemaphoreA(NULL, (LONG) PARSE_QUEUE_SIZE, (LONG) PARSE_QUEUE_SIZE, NULL);
+	queued_jobs = CreateSemaphoreA(NULL, 0, (LONG) PARSE_QUEUE_SIZE, NULL);
+	if (free_slots == NULL || queued_jobs == NULL)
+	{
+		printf("CreateSemaphore generated error %lu\n", (unsigned long) GetLastError());
+		exit(EXIT_FAILURE);
+	}
+
+	for (unsigned i = 0; i < num_threads; i++)
+		threads.emplace_back(&ParsePool::Run, this, i);
+}
+
+// finishes the jobs already queued and stops the threads
+ParsePool::~ParsePool()
+{
+	Stop();
+	CloseHandle(free_slots);
+	CloseHandle(queued_jobs);
+}
+
+// queues a job, waiting while the queue is full
+void ParsePool::Push(ParseJob &&job)
+{
+	// a slot is free once the semaphore is taken, but a consumer may still be finishing its pop from it
+	WaitForSingleObject(free_slots, INFINITE);
+	while (!queue.TryPush(move(job)))
+		this_thread::yield();
+	ReleaseSemaphore(queued_jobs, 1, NULL);
+}
+
+// finishes the jobs already queued and stops the threads
+void ParsePool::Stop()
+{
+	// jobs are taken in order, so every thread sees an empty job only after the real ones
+	for (size_t i = 0; i < threads.size(); i++)
+		Push(ParseJob());
+
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+}
+
+/*
+ * Function: Run
+ * ------------------
+ * Body of each parse thread. Pins the thread to one of the cores in the process
+ * affinity mask (running unpinned if that fails), then takes jobs from the
+ * queue, counts the links in each page with its own parser, frees the page and
+ * hands the job to the done callback. Returns when it takes a job without a
+ * buffer, which Stop queues once per thread.
+ *
+ * input:
+ *   - index: number of this thread, used to pick its core
+ */
+void ParsePool::Run(unsigned index)
+{
+	// spread threads over the cores the process may run on, a job object or container can allow fewer than the machine has
+	DWORD_PTR process_mask = 0, system_mask = 0;
+	if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) && process_mask != 0)
+	{
+		unsigned cores = 0;
+		for (DWORD_PTR mask = process_mask; mask != 0; mask &= mask - 1)
+			cores++;
+
+		// this thread gets the (index % cores)th allowed core
+		DWORD_PTR core = process_mask;
+		for (unsigned skip = index % cores; skip > 0; skip--)
+			core &= core - 1;
+		core &= ~(core - 1);
+
+		if (SetThreadAffinityMask(GetCurrentThread(), core) == 0)
+			printf("parse thread %u could not be pinned, SetThreadAffinityMask generated error %lu\n", index, (unsigned long) GetLastError());
+	}
+	else
+		printf("parse thread %u could not be pinned, GetProcessAffinityMask generated error %lu\n", index, (unsigned long) GetLastError());
+
+	HTMLParserBase parser;
+	ParseJob job;
+
+	for (;;)
+	{
+		// a job is queued once the semaphore is taken, but the producer of an earlier slot may still be writing it
+		WaitForSingleObject(queued_jobs, INFINITE);
+		while (!queue.TryPop(job))
+			this_thread::yield();
+		ReleaseSemaphore(free_slots, 1, NULL);
+
+		if (job.buf == NULL)
+			break;
+
+		int num_links = -1;
+		parser.Parse(job.buf, (int) job.size, &job.base_url[0], (int) job.base_url.length(), &num_links);
+		if (num_links > 0)
+			job.stats.links += num_links;
+
+		free(job.buf);
+		job.buf = NULL;
+		done(job);
+	}
+}
@@ -0,0 +1,62 @@
+// ParsePool.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// most pages waiting to be parsed before fetch threads have to wait, a power of two
+const size_t PARSE_QUEUE_SIZE = 64;
+
+// largest number of parse threads
+const unsigned MAX_PARSE_THREADS = 64;
+
+// a downloaded page waiting to be parsed
+struct ParseJob
+{
+	char *buf;            // the whole response, owned by the job and freed once parsed
+	size_t size;
+	std::string base_url; // http://<host> of the page, HTMLParserBase takes only http:// base URLs
+	int64_t line_start;   // start of the URL's line in the input file
+	CrawlStats stats;     // counts for the URL so far, the parse adds its links
+	std::string host;     // host and IP the URL added to the uniqueness sets, checkpointed once it is finished
+	DWORD IP;
+
+	ParseJob() : buf{ NULL }, size{ 0 }, line_start{ 0 }, IP{ 0 } {}
+};
+
+/*
+ * Pool of threads that parse pages for links, so fetch threads can go back to
+ * their sockets as soon as a page has downloaded. Fetch threads hand each page
+ * over by moving its buffer into a ParseJob, and the job passes through a
+ * lock-free BoundedQueue. Two semaphores count the free and filled slots: a
+ * fetch thread waits when PARSE_QUEUE_SIZE pages are already waiting, which
+ * holds back fetching until parsing catches up, and parse threads sleep when
+ * there is nothing to do. Each parse thread is pinned to one of the cores the
+ * process may run on, in turn, and has its own HTMLParserBase.
+ */
+class ParsePool
+{
+	BoundedQueue<ParseJob> queue;
+	HANDLE free_slots;
+	HANDLE queued_jobs;
+	std::vector<std::thread> threads;
+
+	// called on a parse thread with each job once its links have been counted
+	std::function<void(ParseJob&)> done;
+
+	// parse thread body, runs jobs until it takes one without a buffer
+	void Run(unsigned index);
+
+public:
+	ParsePool(unsigned num_threads, std::function<void(ParseJob&)> _done);
+
+	// finishes the jobs already queued and stops the threads
+	~ParsePool();
+
+	// queues a job, waiting while the queue is full
+	void Push(ParseJob &&job);
+
+	// finishes the jobs already queued and stops the threads
+	void Stop();
+};
@@ -15,18 +15,19 @@ using namespace std;
  *
  * input:
  *   - url: a string in URL format (<scheme>://<host>[:<port>][/<path>][?<query>][#<fragment>])
+ *   - mem: memory resource to allocate the parsed strings from
  * 
  * return: a ParsedURL object with data members initialized to the parsed contents of url,
  *         if the URL could not be successfully parsed, returned object's 'valid' member will
  *         be false.
  */
-ParsedURL ParsedURL::ParseUrl(string url)
+ParsedURL ParsedURL::ParseUrl(string_view url, pmr::memory_resource *mem)
 {  
-	ParsedURL return_val;
+	ParsedURL return_val(mem);
 
 	if (url.empty())
 	{
-		printf("failed with empty URL\n");
+		Log("failed with empty URL\n");
 		return return_val;
 	}
 
@@ -35,10 +36,14 @@ ParsedURL ParsedURL::ParseUrl(string url)
 	{
 		return_val.scheme = url.substr(0, scheme_loc);
 
-		// HTTP is the only currently supported scheme
-		if (return_val.scheme != "http")
+		// HTTP and HTTPS are the only currently supported schemes
+		if (return_val.scheme == "https")
+		{
+			return_val.port = DEFAULT_HTTPS_PORT;
+		}
+		else if (return_val.scheme != "http")
 		{ 
-			printf("failed with invalid scheme\n");
+			Log("failed with invalid scheme\n");
 			return return_val;
 		}
 
@@ -47,7 +52,7 @@ ParsedURL ParsedURL::ParseUrl(string url)
 	// no scheme found
 	else
 	{   
-		printf("failed with invalid scheme\n");
+		Log("failed with invalid scheme\n");
 		return return_val;
 	}
 
@@ -75,13 +80,13 @@ ParsedURL ParsedURL::ParseUrl(string url)
 	}
 
 	// request is /[path][?query]
-	return_val.request = return_val.path + return_val.query;
+	return_val.request.assign(return_val.path).append(return_val.query);
 
 	size_t port_loc = url.find(":");
 	if (port_loc != string::npos && port_loc + 1 < url.length())
 	{
 		// try converting port to an int
-		string port_string = url.substr(port_loc + 1);
+		string port_string(url.substr(port_loc + 1));
 		try
 		{
 			return_val.port = stoi(port_string);
@@ -93,7 +98,7 @@ ParsedURL ParsedURL::ParseUrl(string url)
 		// port was invalid
 		catch (...)
 		{
-			printf("failed with invalid port\n");
+			Log("failed with invalid port\n");
 			return return_val;
 		}
 
@@ -102,7 +107,7 @@ ParsedURL ParsedURL::ParseUrl(string url)
 	// ':' was found at end of string
 	else if (port_loc + 1 >= url.length())
 	{   
-		printf("failed with invalid port\n");
+		Log("failed with invalid port\n");
 		return return_val;
 	}
 
@@ -114,11 +119,24 @@ ParsedURL ParsedURL::ParseUrl(string url)
 	// no host specified
 	else 
 	{
-		printf("failed with invalid host\n");
+		Log("failed with invalid host\n");
 		return return_val;
 	}
 
 	return_val.valid = true;
-	printf("host %s, port %d\n", return_val.host.c_str(), return_val.port);
+	Log("host %s, port %d\n", return_val.host.c_str(), return_val.port);
 	return return_val;
+}
+
+// returns the host portion of url without validating the rest or printing anything, empty if url has no scheme
+string_view ParsedURL::ExtractHost(string_view url)
+{
+	size_t scheme_loc = url.find("://");
+	if (scheme_loc == string::npos)
+		return string_view();
+
+	url = url.substr(scheme_loc + 3);
+
+	// host ends at the port, path, query or fragment, whichever comes first
+	return url.substr(0, url.find_first_of(":/?#\r\n"));
 }
\ No newline at end of file
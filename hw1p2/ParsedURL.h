@@ -8,6 +8,7 @@
 const unsigned MAX_PORT = 65535;
 const unsigned MIN_PORT = 1;
 const unsigned DEFAULT_PORT = 80;
+const unsigned DEFAULT_HTTPS_PORT = 443;
 
 // Basic struct for containing a URL
 struct ParsedURL
@@ -15,18 +16,26 @@ struct ParsedURL
 	// To determine is a given URL is properly formed
 	bool valid; 
 	int port;
-	std::string scheme, host, query, path, request;
+	std::pmr::string scheme, host, query, path, request;
 
-	// Basic default constructor
-	ParsedURL() : scheme{ "" }, host{ "" }, port{ DEFAULT_PORT }, query{ "" }, path{ "/" }, request{ "" }, valid{ false } {} 
+	// Basic default constructor, strings are allocated from mem
+	explicit ParsedURL(std::pmr::memory_resource *mem = std::pmr::get_default_resource()) 
+		: scheme{ "", mem }, host{ "", mem }, port{ DEFAULT_PORT }, query{ "", mem }, path{ "/", mem }, request{ "", mem }, valid{ false } {} 
+
+	// memory resource the strings are allocated from, also used for any other memory needed while crawling this URL
+	std::pmr::memory_resource *Resource() const { return host.get_allocator().resource(); }
 
 	/* 
 	 * input:
 	 *   - url: a string in URL format (<scheme>://<host>[:<port>][/<path>][?<query>][#<fragment>])
+	 *   - mem: memory resource to allocate the parsed strings from
 	 * 
 	 * return: a ParsedURL object with data members initialized to the parsed contents of url, 
 	 *         if the URL could not be successfully parsed, returned object's 'valid' member will
 	 *         be false.
 	 */
-	static ParsedURL ParseUrl(std::string url); 
+	static ParsedURL ParseUrl(std::string_view url, std::pmr::memory_resource *mem = std::pmr::get_default_resource()); 
+
+	// returns the host portion of url without validating the rest or printing anything, empty if url has no scheme
+	static std::string_view ExtractHost(std::string_view url);
 };
\ No newline at end of file
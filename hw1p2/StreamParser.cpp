@@ -0,0 +1,290 @@
+// StreamParser.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+using namespace std;
+
+// clears all state and prepares to parse a new page
+void StreamParser::Reset()
+{
+	state = State::TEXT;
+	kind = Tag::NONE;
+	name.clear();
+	tag.clear();
+	raw_end = nullptr;
+	raw_matched = 0;
+	nofollow = false;
+	num_links = 0;
+}
+
+/*
+ * Function: Feed
+ * ------------------
+ * Scans the next chunk of a page for tags that hold links. Any tag that is not
+ * finished by the end of the chunk is kept and completed by the following call,
+ * and so is a partly matched end of a script or style element.
+ *
+ * input:
+ *   - chunk: pointer to the next bytes of the page (not null-terminated)
+ *   - size: number of bytes in chunk
+ *
+ * return: the total number of links found since the last call to Reset
+ */
+int StreamParser::Feed(const char *chunk, size_t size)
+{
+	const char *pos = chunk;
+	const char *end = chunk + size;
+
+	while (pos < end)
+	{
+		switch (state)
+		{
+		// look for the start of the next tag
+		case State::TEXT:
+			pos = (const char*) memchr(pos, '<', end - pos);
+			if (pos == NULL)
+				return NumLinks();
+			pos++;
+			state = State::TAG_OPEN;
+			break;
+
+		// end tags, comments and declarations hold no links, and a '<' not followed by a name is just text
+		case State::TAG_OPEN:
+			if (isalpha((unsigned char) *pos))
+			{
+				name.clear();
+				state = State::TAG_NAME;
+			}
+			else if (*pos == '/' || *pos == '!' || *pos == '?')
+				state = State::SKIP;
+			else
+				state = State::TEXT;
+			break;
+
+		// read the tag name, which ends at whitespace, '/' or '>'
+		case State::TAG_NAME:
+			while (pos < end && isalnum((unsigned char) *pos))
+			{
+				if (name.size() <= MAX_TAG_NAME_LEN)
+					name.push_back((char) tolower((unsigned char) *pos));
+				pos++;
+			}
+			if (pos == end)
+				return NumLinks();
+
+			StartTag();
+			if (kind != Tag::NONE)
+			{
+				tag.clear();
+				state = State::ATTRIBUTES;
+			}
+			else
+				state = State::SKIP;
+			break;
+
+		// collect attributes until the tag is closed
+		case State::ATTRIBUTES:
+		{
+			const char *close = (const char*) memchr(pos, '>', end - pos);
+			const char *stop = (close == NULL) ? end : close;
+
+			// tag is too long to hold a valid link, drop it
+			if (tag.size() + (stop - pos) > MAX_TAG_LEN)
+			{
+				tag.clear();
+				state = State::SKIP;
+				break;
+			}
+
+			tag.append(pos, stop - pos);
+			if (close == NULL)
+				return NumLinks();
+
+			EndTag();
+			state = State::TEXT;
+			pos = close + 1;
+			break;
+		}
+
+		// ignore everything up to the end of the current tag, a script or style element continues as raw text
+		case State::SKIP:
+			pos = (const char*) memchr(pos, '>', end - pos);
+			if (pos == NULL)
+				return NumLinks();
+			pos++;
+			state = (raw_end != nullptr) ? State::RAW_TEXT : State::TEXT;
+			raw_matched = 0;
+			break;
+
+		// inside a script or style element only its end tag matters, matched one character at a time across chunks
+		case State::RAW_TEXT:
+			if (raw_matched == 0)
+			{
+				pos = (const char*) memchr(pos, '<', end - pos);
+				if (pos == NULL)
+					return NumLinks();
+			}
+
+			if (tolower((unsigned char) *pos) == raw_end[raw_matched])
+			{
+				pos++;
+				if (raw_end[++raw_matched] == '\0')
+				{
+					raw_end = nullptr;
+					state = State::SKIP;
+				}
+			}
+			else
+				raw_matched = 0;
+			break;
+		}
+	}
+
+	return NumLinks();
+}
+
+// decides what to do with the tag whose name has just been read
+void StreamParser::StartTag()
+{
+	kind = Tag::NONE;
+
+	if (name == "a")
+		kind = Tag::ANCHOR;
+	else if (name == "frame" || name == "iframe")
+		kind = Tag::FRAME;
+	else if (name == "meta")
+		kind = Tag::META;
+	else if (name == "script")
+		raw_end = "</script";
+	else if (name == "style")
+		raw_end = "</style";
+}
+
+// counts the links in a complete tag of interest
+void StreamParser::EndTag()
+{
+	// true if text contains word, ignoring case
+	auto contains = [](string_view text, const char *word)
+	{
+		size_t len = strlen(word);
+		for (size_t i = 0; i + len <= text.size(); i++)
+		{
+			if (_strnicmp(text.data() + i, word, len) == 0)
+				return true;
+		}
+		return false;
+	};
+
+	string_view value, content;
+	switch (kind)
+	{
+	case Tag::ANCHOR:
+		if (GetAttribute("href", value))
+			CountLink(value);
+		break;
+
+	case Tag::FRAME:
+		if (GetAttribute("src", value))
+			CountLink(value);
+		break;
+
+	// robots directives and refresh redirects both keep their value in content
+	case Tag::META:
+		if (!GetAttribute("content", content))
+			break;
+
+		if (GetAttribute("name", value) && value.size() == 6 && _strnicmp(value.data(), "robots", 6) == 0)
+		{
+			if (contains(content, "nofollow") || contains(content, "none"))
+				nofollow = true;
+		}
+		else if (GetAttribute("http-equiv", value) && value.size() == 7 && _strnicmp(value.data(), "refresh", 7) == 0)
+		{
+			// content is "<seconds>; url=<link>"
+			for (size_t i = 0; i + 4 <= content.size(); i++)
+			{
+				if (_strnicmp(content.data() + i, "url=", 4) == 0)
+				{
+					value = content.substr(i + 4);
+					while (!value.empty() && (isspace((unsigned char) value.front()) || value.front() == '\'' || value.front() == '"'))
+						value.remove_prefix(1);
+					while (!value.empty() && (isspace((unsigned char) value.back()) || value.back() == '\'' || value.back() == '"'))
+						value.remove_suffix(1);
+					CountLink(value);
+					break;
+				}
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/*
+ * Function: GetAttribute
+ * ------------------
+ * Finds an attribute in the tag being read. Its name must start a new word and
+ * be followed by '=', and its value is either quoted or runs to the next
+ * whitespace.
+ *
+ * input:
+ *   - attribute: lower case name of the attribute
+ * output:
+ *   - value: the attribute's value without quotes, pointing into tag
+ *
+ * return: true if the attribute was found, false otherwise
+ */
+bool StreamParser::GetAttribute(const char *attribute, string_view &value) const
+{
+	size_t len = tag.length();
+	size_t name_len = strlen(attribute);
+
+	for (size_t i = 0; i + name_len <= len; i++)
+	{
+		if (_strnicmp(tag.c_str() + i, attribute, name_len) != 0 || (i > 0 && !isspace((unsigned char) tag[i - 1])))
+			continue;
+
+		// skip to the attribute value
+		size_t j = i + name_len;
+		while (j < len && isspace((unsigned char) tag[j]))
+			j++;
+		if (j >= len || tag[j] != '=')
+			continue;
+		j++;
+		while (j < len && isspace((unsigned char) tag[j]))
+			j++;
+
+		// value is either quoted or ends at the next whitespace
+		char quote = '\0';
+		if (j < len && (tag[j] == '"' || tag[j] == '\''))
+			quote = tag[j++];
+
+		size_t start = j;
+		while (j < len && (quote ? tag[j] != quote : !isspace((unsigned char) tag[j])))
+			j++;
+
+		value = string_view(tag.c_str() + start, j - start);
+		return true;
+	}
+
+	return false;
+}
+
+// counts link if it resolves to an http link
+void StreamParser::CountLink(string_view link)
+{
+	if (link.empty() || link[0] == '#')
+		return;
+
+	// some other scheme (https:, mailto:, javascript:, etc.)
+	if (!(link.size() >= 7 && _strnicmp(link.data(), "http://", 7) == 0) && link.find(':') < link.find_first_of("/?#"))
+		return;
+
+	// absolute http links, and relative ones which resolve against the page's http:// base URL
+	num_links++;
+}
@@ -0,0 +1,77 @@
+// StreamParser.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// longest link-bearing tag that will be carried over between chunks, longer tags are dropped
+const size_t MAX_TAG_LEN = MAX_URL_LEN + 256;
+
+// longest tag name that is looked at, every tag of interest is shorter
+const size_t MAX_TAG_NAME_LEN = 8;
+
+/*
+ * Push-style link counter. The body of a page is fed in arbitrary chunks as it
+ * arrives from the socket and links are counted as soon as their tag is
+ * complete. Tags split across chunk boundaries are carried over, so the only
+ * state kept between chunks is bounded by MAX_TAG_LEN regardless of page size.
+ * Links are not stored, only counted.
+ *
+ * Links are taken from <a href>, <frame src>, <iframe src> and the url= part
+ * of <meta http-equiv=refresh>. Anything inside <script> and <style> is not
+ * markup and is skipped, and a page with <meta name=robots> whose content is
+ * nofollow or none has no links. Like HTMLParserBase, which is handed an
+ * http:// base URL, only links that resolve to http are counted: absolute
+ * http:// links and relative ones. Fragments and other schemes are skipped.
+ *
+ * These rules follow the tags HTMLParserBase handles, but its tokenizer is not
+ * ours and its exact rules are not documented, so counts for the same page can
+ * differ from the ones it gives (pages that are chunked or parsed on a parse
+ * thread are counted by HTMLParserBase).
+ *
+ * The parser itself keeps no copy of the page, but Read still keeps the whole
+ * response in its buffer, since the archive, the parse pool and the header
+ * printout all need it once the download is done.
+ */
+class StreamParser
+{
+	// scanner state between chunks
+	enum class State { TEXT, TAG_OPEN, TAG_NAME, ATTRIBUTES, SKIP, RAW_TEXT };
+
+	// tags whose attributes are read
+	enum class Tag { NONE, ANCHOR, FRAME, META };
+
+	State state;
+	Tag kind;
+	std::string name;      // name of the tag currently being read, lower case
+	std::string tag;       // attributes of the tag currently being read
+	const char *raw_end;   // closing tag that ends the current script or style element
+	size_t raw_matched;    // characters of raw_end matched so far
+	bool nofollow;         // page asked robots not to follow its links
+	int num_links;
+
+	// decides what to do with the tag whose name has just been read
+	void StartTag();
+
+	// counts the links in a complete tag of interest
+	void EndTag();
+
+	// finds the named attribute in tag, returns false if it is not there
+	bool GetAttribute(const char *attribute, std::string_view &value) const;
+
+	// counts link if it resolves to an http link
+	void CountLink(std::string_view link);
+
+public:
+	StreamParser() : state{ State::TEXT }, kind{ Tag::NONE }, raw_end{ nullptr }, raw_matched{ 0 }, nofollow{ false }, num_links{ 0 } {}
+
+	// clears all state and prepares to parse a new page
+	void Reset();
+
+	// consumes the next chunk of the page, returns total number of links found so far
+	int Feed(const char *chunk, size_t size);
+
+	// total number of links found since the last reset
+	int NumLinks() const { return nofollow ? 0 : num_links; }
+};
@@ -0,0 +1,318 @@
+// TLSConnection.cpp
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#include "pch.h"
+
+#pragma comment(lib, "secur32.lib")
+
+using namespace std;
+
+// context requirements for every handshake
+const DWORD TLS_CONTEXT_FLAGS = ISC_REQ_SEQUENCE_DETECT | ISC_REQ_REPLAY_DETECT | ISC_REQ_CONFIDENTIALITY |
+                                ISC_REQ_ALLOCATE_MEMORY | ISC_REQ_STREAM;
+
+CredHandle TLSConnection::credentials;
+bool TLSConnection::has_credentials = false;
+bool TLSConnection::skip_validation = false;
+once_flag TLSConnection::credentials_flag;
+
+// releases the security context
+TLSConnection::~TLSConnection()
+{
+	Close();
+}
+
+// acquires the shared credential handle, returns -1 for failure and 0 for success
+int TLSConnection::AcquireCredentials()
+{
+	call_once(credentials_flag, []
+	{
+		SCHANNEL_CRED cred = { 0 };
+		cred.dwVersion = SCHANNEL_CRED_VERSION;
+		cred.grbitEnabledProtocols = SP_PROT_TLS1_2_CLIENT;
+
+		// no client certificate, server certificates are checked against the host name and trusted roots unless told not to
+		cred.dwFlags = SCH_CRED_NO_DEFAULT_CREDS | (skip_validation ? SCH_CRED_MANUAL_CRED_VALIDATION : SCH_CRED_AUTO_CRED_VALIDATION);
+
+		SECURITY_STATUS status = AcquireCredentialsHandleA(NULL, (SEC_CHAR*) UNISP_NAME_A, SECPKG_CRED_OUTBOUND, NULL, &cred,
+		                                                   NULL, NULL, &credentials, NULL);
+		if (status != SEC_E_OK)
+		{
+			Log("AcquireCredentialsHandle generated error 0x%lx\n", (unsigned long) status);
+			return;
+		}
+
+		has_credentials = true;
+	});
+
+	return has_credentials ? 0 : -1;
+}
+
+/*
+ * Function: Handshake
+ * ------------------
+ * Negotiates a TLS session with the server on the other end of sock. Tokens
+ * produced by Schannel are sent to the server and its replies fed back in until
+ * the context is complete. Any application data received with the last
+ * handshake message is kept for Recv.
+ *
+ * input:
+ *   - sock: a socket already connected to the server
+ *   - host: name of the server, also the key for Schannel's session cache
+ *
+ * return: -1 if the handshake failed, 0 otherwise
+ */
+int TLSConnection::Handshake(SOCKET sock, const char *host)
+{
+	if (AcquireCredentials() < 0)
+		return -1;
+
+	Close();
+
+	DWORD out_flags = 0;
+	SecBuffer out_buf = { 0, SECBUFFER_TOKEN, NULL };
+	SecBufferDesc out_desc = { SECBUFFER_VERSION, 1, &out_buf };
+
+	// first call produces the ClientHello, which carries the cached session for host if there is one
+	SECURITY_STATUS status = InitializeSecurityContextA(&credentials, NULL, (SEC_CHAR*) host, TLS_CONTEXT_FLAGS, 0, 0,
+	                                                    NULL, 0, &context, &out_desc, &out_flags, NULL);
+	if (status != SEC_I_CONTINUE_NEEDED)
+	{
+		Log("failed with TLS error 0x%lx\n", (unsigned long) status);
+		return -1;
+	}
+	has_context = true;
+
+	int ret = SendAll(sock, (char*) out_buf.pvBuffer, out_buf.cbBuffer);
+	FreeContextBuffer(out_buf.pvBuffer);
+	if (ret < 0)
+		return -1;
+
+	while (status == SEC_I_CONTINUE_NEEDED || status == SEC_E_INCOMPLETE_MESSAGE)
+	{
+		// need more from the server before the next step
+		if (in.empty() || status == SEC_E_INCOMPLETE_MESSAGE)
+		{
+			if (RecvEncrypted(sock) <= 0)
+			{
+				Log("failed with %d during TLS handshake\n", WSAGetLastError());
+				return -1;
+			}
+		}
+
+		SecBuffer in_bufs[2] = { { (ULONG) in.size(), SECBUFFER_TOKEN, in.data() }, { 0, SECBUFFER_EMPTY, NULL } };
+		SecBufferDesc in_desc = { SECBUFFER_VERSION, 2, in_bufs };
+		out_buf = { 0, SECBUFFER_TOKEN, NULL };
+
+		status = InitializeSecurityContextA(&credentials, &context, (SEC_CHAR*) host, TLS_CONTEXT_FLAGS, 0, 0,
+		                                    &in_desc, 0, NULL, &out_desc, &out_flags, NULL);
+		if (status == SEC_E_INCOMPLETE_MESSAGE)
+			continue;
+
+		// send whatever Schannel produced, even on failure it may be an alert for the server
+		if (out_buf.cbBuffer > 0 && out_buf.pvBuffer != NULL)
+		{
+			ret = SendAll(sock, (char*) out_buf.pvBuffer, out_buf.cbBuffer);
+			FreeContextBuffer(out_buf.pvBuffer);
+			if (ret < 0)
+				return -1;
+		}
+
+		// keep bytes belonging to the next message
+		if (in_bufs[1].BufferType == SECBUFFER_EXTRA)
+		{
+			memmove(in.data(), in.data() + (in.size() - in_bufs[1].cbBuffer), in_bufs[1].cbBuffer);
+			in.resize(in_bufs[1].cbBuffer);
+		}
+		else
+			in.clear();
+	}
+
+	if (status != SEC_E_OK)
+	{
+		Log("failed with TLS error 0x%lx\n", (unsigned long) status);
+		return -1;
+	}
+
+	status = QueryContextAttributesA(&context, SECPKG_ATTR_STREAM_SIZES, &sizes);
+	if (status != SEC_E_OK)
+	{
+		Log("failed with TLS error 0x%lx\n", (unsigned long) status);
+		return -1;
+	}
+
+	out.resize(sizes.cbHeader + sizes.cbMaximumMessage + sizes.cbTrailer);
+	return 0;
+}
+
+// true if the last handshake resumed a cached session
+bool TLSConnection::Resumed()
+{
+	SecPkgContext_SessionInfo info = { 0 };
+	if (!has_context || QueryContextAttributesA(&context, SECPKG_ATTR_SESSION_INFO, &info) != SEC_E_OK)
+		return false;
+
+	return (info.dwFlags & SSL_SESSION_RECONNECT) != 0;
+}
+
+// encrypts and sends len bytes of data, returns -1 for failure and 0 for success
+int TLSConnection::Send(SOCKET sock, const char *data, size_t len)
+{
+	while (len > 0)
+	{
+		ULONG chunk = (ULONG) min(len, (size_t) sizes.cbMaximumMessage);
+		memcpy(out.data() + sizes.cbHeader, data, chunk);
+
+		SecBuffer bufs[4] = {
+			{ sizes.cbHeader, SECBUFFER_STREAM_HEADER, out.data() },
+			{ chunk, SECBUFFER_DATA, out.data() + sizes.cbHeader },
+			{ sizes.cbTrailer, SECBUFFER_STREAM_TRAILER, out.data() + sizes.cbHeader + chunk },
+			{ 0, SECBUFFER_EMPTY, NULL }
+		};
+		SecBufferDesc desc = { SECBUFFER_VERSION, 4, bufs };
+
+		SECURITY_STATUS status = EncryptMessage(&context, 0, &desc, 0);
+		if (status != SEC_E_OK)
+		{
+			Log("failed with TLS error 0x%lx\n", (unsigned long) status);
+			return -1;
+		}
+
+		// trailer may be shorter than its maximum
+		if (SendAll(sock, out.data(), (size_t) bufs[0].cbBuffer + bufs[1].cbBuffer + bufs[2].cbBuffer) < 0)
+			return -1;
+
+		data += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+/*
+ * Function: Recv
+ * ------------------
+ * Returns decrypted application data, reading and decrypting more records from
+ * the socket only when nothing is left over from the previous call.
+ *
+ * input:
+ *   - sock: the socket the handshake was done on
+ *   - buf: destination for decrypted data
+ *   - len: space available in buf
+ *
+ * return: the number of bytes copied to buf, 0 if the server closed the
+ *         connection or -1 for failure
+ */
+int TLSConnection::Recv(SOCKET sock, char *buf, size_t len)
+{
+	for (;;)
+	{
+		// hand out data left from the last record first
+		if (plain_pos < plain.size())
+		{
+			size_t n = min(len, plain.size() - plain_pos);
+			memcpy(buf, plain.data() + plain_pos, n);
+			plain_pos += n;
+			return (int) n;
+		}
+
+		if (!in.empty())
+		{
+			SecBuffer bufs[4] = {
+				{ (ULONG) in.size(), SECBUFFER_DATA, in.data() },
+				{ 0, SECBUFFER_EMPTY, NULL },
+				{ 0, SECBUFFER_EMPTY, NULL },
+				{ 0, SECBUFFER_EMPTY, NULL }
+			};
+			SecBufferDesc desc = { SECBUFFER_VERSION, 4, bufs };
+
+			SECURITY_STATUS status = DecryptMessage(&context, &desc, 0, NULL);
+			if (status == SEC_E_OK)
+			{
+				SecBuffer *data = NULL, *extra = NULL;
+				for (SecBuffer &b : bufs)
+				{
+					if (b.BufferType == SECBUFFER_DATA)
+						data = &b;
+					else if (b.BufferType == SECBUFFER_EXTRA)
+						extra = &b;
+				}
+
+				// decrypted in place, so copy the data out before moving the extra bytes down
+				plain_pos = 0;
+				if (data != NULL)
+					plain.assign((char*) data->pvBuffer, (char*) data->pvBuffer + data->cbBuffer);
+				else
+					plain.clear();
+
+				if (extra != NULL)
+				{
+					memmove(in.data(), in.data() + (in.size() - extra->cbBuffer), extra->cbBuffer);
+					in.resize(extra->cbBuffer);
+				}
+				else
+					in.clear();
+
+				continue;
+			}
+			// server sent close_notify
+			else if (status == SEC_I_CONTEXT_EXPIRED)
+				return 0;
+			else if (status != SEC_E_INCOMPLETE_MESSAGE)
+			{
+				Log("failed with TLS error 0x%lx on recv\n", (unsigned long) status);
+				return -1;
+			}
+		}
+
+		int bytes = RecvEncrypted(sock);
+		if (bytes <= 0)
+			return bytes;
+	}
+}
+
+// releases the security context so the object can be used for another connection
+void TLSConnection::Close()
+{
+	if (has_context)
+	{
+		DeleteSecurityContext(&context);
+		has_context = false;
+	}
+
+	in.clear();
+	plain.clear();
+	plain_pos = 0;
+}
+
+// appends up to TLS_READ_SIZE encrypted bytes from sock to in, returns the result of recv
+int TLSConnection::RecvEncrypted(SOCKET sock)
+{
+	size_t old_size = in.size();
+	in.resize(old_size + TLS_READ_SIZE);
+
+	int bytes = recv(sock, in.data() + old_size, TLS_READ_SIZE, 0);
+	in.resize(old_size + (bytes > 0 ? bytes : 0));
+	return bytes;
+}
+
+// sends all len bytes of buf over sock, returns -1 for failure and 0 for success
+int TLSConnection::SendAll(SOCKET sock, const char *buf, size_t len)
+{
+	while (len > 0)
+	{
+		int bytes = send(sock, buf, (int) len, 0);
+		if (bytes == SOCKET_ERROR)
+		{
+			Log("failed with %d\n", WSAGetLastError());
+			return -1;
+		}
+
+		buf += bytes;
+		len -= bytes;
+	}
+
+	return 0;
+}
@@ -0,0 +1,73 @@
+// TLSConnection.h
+// CSCE 463-500
+// Luke Grammer
+// 10/19/26
+
+#pragma once
+
+// size of each encrypted read from the socket
+const UINT TLS_READ_SIZE = 16 * 1024;
+
+/*
+ * Client side of a TLS connection over an already connected socket, built on
+ * Schannel. All connections share one credential handle, and Schannel keys its
+ * session cache on that handle and the target host name, so every handshake
+ * after the first to a given host resumes the cached session (session ID or
+ * ticket) instead of doing a full key exchange.
+ *
+ * Schannel validates each server's certificate chain and host name during the
+ * handshake. SetSkipValidation turns this off for testing against servers with
+ * self-signed certificates, such as tls-test-server.py, which serves the URL in
+ * URL-input-tls.txt.
+ */
+class TLSConnection
+{
+	// credential handle shared by every connection, acquired on first use
+	static CredHandle credentials;
+	static bool has_credentials;
+	static std::once_flag credentials_flag;
+	static bool skip_validation;
+
+	CtxtHandle context;
+	bool has_context;
+	SecPkgContext_StreamSizes sizes;
+
+	std::vector<char> in;    // encrypted bytes received but not yet decrypted
+	std::vector<char> plain; // decrypted bytes not yet returned by Recv
+	size_t plain_pos;
+	std::vector<char> out;   // scratch buffer for encrypted records
+
+	// acquires the shared credential handle, returns -1 for failure and 0 for success
+	static int AcquireCredentials();
+
+	// appends up to TLS_READ_SIZE encrypted bytes from sock to in, returns the result of recv
+	int RecvEncrypted(SOCKET sock);
+
+	// sends all len bytes of buf over sock, returns -1 for failure and 0 for success
+	static int SendAll(SOCKET sock, const char *buf, size_t len);
+
+public:
+	TLSConnection() : context{ 0 }, has_context{ false }, sizes{ 0 }, plain_pos{ 0 } {}
+	~TLSConnection();
+
+	// accepts any server certificate, must be called before the first handshake
+	static void SetSkipValidation(bool skip) { skip_validation = skip; }
+
+	// performs the client handshake for host over sock, returns -1 for failure and 0 for success
+	int Handshake(SOCKET sock, const char *host);
+
+	// true if the last handshake resumed a cached session
+	bool Resumed();
+
+	// encrypts and sends len bytes of data, returns -1 for failure and 0 for success
+	int Send(SOCKET sock, const char *data, size_t len);
+
+	// receives up to len decrypted bytes into buf, returns the number of bytes, 0 if the connection closed or -1 for failure
+	int Recv(SOCKET sock, char *buf, size_t len);
+
+	// true if Recv can return data without waiting on the socket
+	bool Pending() const { return plain_pos < plain.size() || !in.empty(); }
+
+	// releases the security context so the object can be used for another connection
+	void Close();
+};
@@ -7,27 +7,20 @@
 
 using namespace std;
 
-// basic constructor initializes winsock and opens a TCP socket
-WebCrawler::WebCrawler(ParsedURL _url) : remote { nullptr }, server{ NULL }, parser{HTMLParserBase()}
+// basic constructor initializes winsock, connections are drawn from _pool and timings reported to _controller when they are given
+WebCrawler::WebCrawler(ConnectionPool *_pool, ConcurrencyController *_controller) : remote { nullptr }, server{ NULL }, parser{HTMLParserBase()},
+	url{ nullptr }, sock{ INVALID_SOCKET }, secure{ false }, pool{ _pool }, has_slot{ false }, reusable{ false }, head_request{ false },
+	controller{ _controller }, header_len{ 0 }, body_len{ -1 }, chunked{ false }, keep_alive{ false },
+	chunk_state{ ChunkState::SIZE }, chunk_pos{ 0 }, chunk_left{ 0 }, stream_links{ true },
+	streamed{ false }, stream_time{ 0 }
 {   
 	WSADATA wsa_data;
 	WORD w_ver_requested;
-	
-	url = _url;
 
 	//initialize WinSock
 	w_ver_requested = MAKEWORD(2, 2);
 	if (WSAStartup(w_ver_requested, &wsa_data) != 0) {
-		printf("\tWSAStartup error %d\n", WSAGetLastError());
-		WSACleanup();
-		exit(EXIT_FAILURE);
-	}
-
-	// open a TCP socket
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (sock == INVALID_SOCKET)
-	{
-		printf("\tsocket() generated error %d\n", WSAGetLastError());
+		Log("\tWSAStartup error %d\n", WSAGetLastError());
 		WSACleanup();
 		exit(EXIT_FAILURE);
 	}
@@ -36,14 +29,14 @@ WebCrawler::WebCrawler(ParsedURL _url) : remote { nullptr }, server{ NULL }, par
 // destructor cleans up winsock and closes socket
 WebCrawler::~WebCrawler() 
 {   
-	closesocket(sock);
+	ResetConnection();
 	WSACleanup();
 }
 
-// basic setter for the url data member
-void WebCrawler::SetUrl(ParsedURL _url)
+// basic setter for the url data member, _url must outlive its use by the crawler
+void WebCrawler::SetUrl(const ParsedURL &_url)
 {
-	url = _url;
+	url = &_url;
 }
 
 // resolves DNS for the host specified by the url member and returns an IP address or -1 for failure
@@ -53,21 +46,18 @@ int WebCrawler::ResolveDNS()
 	DWORD IP;
 	struct in_addr addr;
 
-	if (!url.valid)
+	if (url == nullptr || !url->valid)
 	{
-		printf("supplied url not valid in resolveDNS()\n");
+		Log("supplied url not valid in resolveDNS()\n");
 		return -1;
 	}
 	
-	host = (char*) malloc(MAX_HOST_LEN);
-	if (host == NULL)
-	{
-		printf("malloc failure for hostname\n");
-		return -1;
-	}
+	// scratch memory comes from the same per-URL resource as the url itself
+	pmr::memory_resource *mem = url->Resource();
+	host = (char*) mem->allocate(MAX_HOST_LEN, 1);
 
 	// need to put the hostname in a C string
-	strcpy_s(host, MAX_HOST_LEN, url.host.c_str()); 
+	strcpy_s(host, MAX_HOST_LEN, url->host.c_str()); 
 
 	start_time = chrono::high_resolution_clock::now();
     
@@ -79,96 +69,247 @@ int WebCrawler::ResolveDNS()
 	{   
 		if ((remote = gethostbyname(host)) == NULL) 
 		{
-			printf("failed with %d\n", WSAGetLastError());
-			free(host);
+			// a resolver that cannot answer in time is a sign of too many lookups at once, unlike a name that does not exist
+			int error = WSAGetLastError();
+			if (controller != nullptr && error == WSATRY_AGAIN)
+				controller->Record(ConcurrencyController::DNS, 0, true);
+
+			Log("failed with %d\n", error);
+			mem->deallocate(host, MAX_HOST_LEN, 1);
 			return 0;
 		}
 		// take the first IP address and copy into sin_addr, stop timer and print
 		else 
 		{   
 			stop_time = chrono::high_resolution_clock::now();
+			if (controller != nullptr)
+				controller->Record(ConcurrencyController::DNS, (DWORD) chrono::duration_cast<chrono::milliseconds>(stop_time - start_time).count(), false);
+
 			IP = *(u_long*)remote->h_addr;
 			addr.s_addr = IP;
 			memcpy((char*) &(server.sin_addr), remote->h_addr, remote->h_length);
-			printf("done in %" PRIu64 " ms, found %s\n", 
-				   chrono::duration_cast<chrono::milliseconds>
-				   (stop_time - start_time).count(), inet_ntoa(addr));
+			Log("done in %" PRIu64 " ms, found %s\n", 
+				chrono::duration_cast<chrono::milliseconds>
+				(stop_time - start_time).count(), inet_ntoa(addr));
 		}
 	}
 	// host is a valid IP, directly drop its binary version into sin_addr, stop timer and print
 	else
 	{
 		stop_time = chrono::high_resolution_clock::now();
-		printf("done in %" PRIu64 " ms, found %s\n", 
-			   chrono::duration_cast<chrono::milliseconds>
-			   (stop_time - start_time).count(), host);
+		Log("done in %" PRIu64 " ms, found %s\n", 
+			chrono::duration_cast<chrono::milliseconds>
+			(stop_time - start_time).count(), host);
 		server.sin_addr.S_un.S_addr = IP;
 	}
 
-	free(host);
+	mem->deallocate(host, MAX_HOST_LEN, 1);
 	return IP;
 }
 
-// creates a TCP connection to a server, returns -1 for failure and 0 for success
+// creates a TCP connection to a server (with a TLS session on top for https) or reuses a pooled one, returns -1 for failure and 0 for success
 int WebCrawler::CreateConnection()
 { 
-	if (!url.valid)
+	if (url == nullptr || !url->valid)
 	{
-		printf("supplied url not valid in createConnection()\n");
+		Log("supplied url not valid in createConnection()\n");
 		return -1;
 	}
 
+	// drop whatever connection was left open
+	ResetConnection();
+
 	// set up the port # and protocol type
 	server.sin_family = AF_INET;
-	server.sin_port = htons(url.port); 
+	server.sin_port = htons(url->port); 
 
-	// start timer and connect to the server
 	start_time = chrono::high_resolution_clock::now();
-	if (connect(sock, (struct sockaddr*) &server, sizeof(struct sockaddr_in)) == SOCKET_ERROR)
+
+	// take a connection slot for the host, reusing an idle keep-alive connection to it when there is one
+	if (pool != nullptr)
 	{
-		printf("failed with %d\n", WSAGetLastError());
+		pool_key.assign(url->host).append(":").append(to_string(url->port));
+		sock = pool->Checkout(pool_key);
+		has_slot = true;
+
+		if (sock != INVALID_SOCKET)
+		{
+			stop_time = chrono::high_resolution_clock::now();
+			Log("reused connection in %" PRIu64 " ms\n", 
+				chrono::duration_cast<chrono::milliseconds>
+				(stop_time - start_time).count());
+			return 0;
+		}
+	}
+
+	// open a TCP socket
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock == INVALID_SOCKET)
+	{
+		Log("socket() generated error %d\n", WSAGetLastError());
 		return -1;
 	}
+
+	// bound every blocking read here rather than with a select before each one, pooled sockets keep the timeout
+	DWORD timeout_ms = (controller != nullptr) ? controller->Timeout(ConcurrencyController::READ) : TIMEOUT_SECONDS * 1000;
+	if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char*) &timeout_ms, sizeof(timeout_ms)) == SOCKET_ERROR)
+	{
+		Log("setsockopt() generated error %d\n", WSAGetLastError());
+		return -1;
+	}
+
+	// connect to the server, time spent waiting for a pool slot does not count
+	start_time = chrono::high_resolution_clock::now();
+	timeout_ms = (controller != nullptr) ? controller->Timeout(ConcurrencyController::CONNECT) : TIMEOUT_SECONDS * 1000;
+	int error = Connect(timeout_ms);
 	stop_time = chrono::high_resolution_clock::now();
 
-	printf("done in %" PRIu64 " ms\n", 
-		   chrono::duration_cast<chrono::milliseconds>
-		   (stop_time - start_time).count());
+	if (controller != nullptr && (error == 0 || error == WSAETIMEDOUT))
+		controller->Record(ConcurrencyController::CONNECT, (DWORD) chrono::duration_cast<chrono::milliseconds>(stop_time - start_time).count(),
+		                   error == WSAETIMEDOUT);
+
+	if (error != 0)
+	{
+		Log("failed with %d\n", error);
+		return -1;
+	}
+
+	Log("done in %" PRIu64 " ms\n", 
+		chrono::duration_cast<chrono::milliseconds>
+		(stop_time - start_time).count());
+
+	// negotiate TLS on top of the connection, resuming the cached session for this host if there is one
+	if (url->scheme == "https")
+	{
+		Log("\tTLS handshake... ");
+		start_time = chrono::high_resolution_clock::now();
+		if (tls.Handshake(sock, url->host.c_str()) < 0)
+			return -1;
+		stop_time = chrono::high_resolution_clock::now();
+		secure = true;
+
+		Log("done in %" PRIu64 " ms%s\n", 
+			chrono::duration_cast<chrono::milliseconds>
+			(stop_time - start_time).count(), tls.Resumed() ? ", session resumed" : "");
+	}
 
 	return 0;
 }
 
-// writes a properly formatted HTTP query to the connected server, returns -1 for failure and 0 for success
-int WebCrawler::Write(string request_type, string request)
+/*
+ * Function: Connect
+ * ------------------
+ * Connects sock to the server without blocking, then waits at most timeout_ms
+ * for the connection to complete, so a dead host costs no more than the
+ * current timeout. The socket is switched back to blocking once connected.
+ *
+ * input:
+ *   - timeout_ms: longest time to wait for the connection
+ *
+ * return: 0 if the connection was made, otherwise the Winsock error code
+ *         (WSAETIMEDOUT if the time ran out)
+ */
+int WebCrawler::Connect(DWORD timeout_ms)
 {
-	if (request == "")
-		request = url.request;
+	u_long non_blocking = 1;
+	if (ioctlsocket(sock, FIONBIO, &non_blocking) == SOCKET_ERROR)
+		return WSAGetLastError();
 
-	string http_request = request_type + " " + request + " HTTP/1.1\r\nUser-agent: " + 
-		        AGENT_NAME + "\r\nHost: " + url.host + "\r\nConnection: close\r\n\r\n";
+	if (connect(sock, (struct sockaddr*) &server, sizeof(struct sockaddr_in)) == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() != WSAEWOULDBLOCK)
+			return WSAGetLastError();
+
+		// writable once connected, a failed connect shows up in the exception set
+		fd_set writable, failed;
+		FD_ZERO(&writable);
+		FD_ZERO(&failed);
+		FD_SET(sock, &writable);
+		FD_SET(sock, &failed);
+
+		struct timeval timeout;
+		timeout.tv_sec = timeout_ms / 1000;
+		timeout.tv_usec = (timeout_ms % 1000) * 1000;
+
+		int ret = select((int) sock + 1, NULL, &writable, &failed, &timeout);
+		if (ret == 0)
+			return WSAETIMEDOUT;
+		if (ret == SOCKET_ERROR)
+			return WSAGetLastError();
+
+		int error = 0;
+		int len = sizeof(error);
+		if (getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*) &error, &len) == SOCKET_ERROR)
+			return WSAGetLastError();
+		if (error != 0)
+			return error;
+	}
+
+	non_blocking = 0;
+	if (ioctlsocket(sock, FIONBIO, &non_blocking) == SOCKET_ERROR)
+		return WSAGetLastError();
+
+	return 0;
+}
 
-	if (send(sock, http_request.c_str(), (int) strlen(http_request.c_str()), NULL) < 0)
+// writes an HTTP request for target (the url's own if empty) to the connected server, asking the server to close the connection
+// after it if last is set, returns -1 for failure and 0 for success
+int WebCrawler::Write(string_view method, string_view target, bool last)
+{
+	if (target.empty())
+		target = url->request;
+
+	// the request is built in the same buffer every time, around the headers that never change
+	// HTTP/1.1 connections persist by default, so ask for a close when the connection will not be pooled
+	bool close = last || pool == nullptr;
+	request_buf.assign(method.data(), method.size()).append(" ").append(target).append(REQUEST_AGENT).append(url->host)
+	           .append(close ? "\r\nConnection: close\r\n\r\n" : "\r\n\r\n");
+	head_request = (method == "HEAD");
+
+	int ret = secure ? tls.Send(sock, request_buf.data(), request_buf.size())
+	                 : send(sock, request_buf.data(), (int) request_buf.size(), NULL);
+	if (ret < 0)
 	{
-		printf("failed with %d\n", WSAGetLastError());
+		Log("failed with %d\n", WSAGetLastError());
 		return -1;
 	}
 
 	return 0;
 }
 
-// receives HTTP response from connected server
-int WebCrawler::Read(char* &buf, const size_t read_limit, size_t &cur_size, size_t &allocated_size)
+// receives HTTP response from connected server, extracting links from the body and fingerprinting it as it arrives if stream is set
+int WebCrawler::Read(char* &buf, const size_t read_limit, size_t &cur_size, size_t &allocated_size, bool stream)
 {
-	// set socket timeout value
-	struct timeval timeout; 
-	timeout.tv_sec = TIMEOUT_SECONDS; 
-	timeout.tv_usec = 0;
+	cur_size = 0;
 
-	int ret = 0;
-	fd_set fd;
-	FD_ZERO(&fd);
+	// framing is unknown until the header has been received
+	header_len = 0;
+	body_len = -1;
+	chunked = false;
+	keep_alive = false;
+	reusable = false;
+	chunk_state = ChunkState::SIZE;
+	chunk_left = 0;
 
-	cur_size = 0;
+	// number of body bytes already given to the stream parser
+	size_t fed = 0;
+
+	// where the search for the end of the header resumes
+	size_t header_from = 0;
+	bool first_byte = true;
+
+	// the fingerprint is still taken when links are left to a parse thread or a chunked body turns streaming off
+	bool hashing = stream;
+	stream = stream && stream_links;
+
+	streamed = false;
+	stream_time = chrono::high_resolution_clock::duration::zero();
+	if (stream)
+		stream_parser.Reset();
+
+	fingerprint = PageFingerprint();
+	if (hashing)
+		hasher.Reset();
 
 	// start connection timer
 	start_time = chrono::high_resolution_clock::now();
@@ -176,97 +317,152 @@ int WebCrawler::Read(char* &buf, const size_t read_limit, size_t &cur_size, size
 	while ((chrono::duration_cast<chrono::milliseconds>(stop_time - start_time).count() / 1000.0) < MAX_CONNECTION_TIME &&
 		   cur_size < read_limit)
 	{
-		FD_SET(sock, &fd);
+		// block until data arrives, the socket's receive timeout (SO_RCVTIMEO) ends the wait if none does
+		int bytes = secure ? tls.Recv(sock, buf + cur_size, allocated_size - cur_size)
+		                   : recv(sock, buf + cur_size, (int) (allocated_size - cur_size), NULL);
+		if (bytes < 0)
+		{
+			stop_time = chrono::high_resolution_clock::now();
+			if (WSAGetLastError() == WSAETIMEDOUT)
+			{
+				if (controller != nullptr)
+					controller->Record(ConcurrencyController::READ, 0, true);
+				Log("socket timeout\n");
+			}
+			else
+				Log("failed with %d on recv\n", WSAGetLastError());
+			return -1;
+		}
+
+		// time to first byte tracks how long servers take to answer, unlike the full download it does not grow with page size
+		if (first_byte && bytes > 0 && controller != nullptr)
+			controller->Record(ConcurrencyController::READ, (DWORD) chrono::duration_cast<chrono::milliseconds>
+			                   (chrono::high_resolution_clock::now() - start_time).count(), false);
+
+		// advance current position by number of bytes read
+		if (bytes > 0)
+			first_byte = false;
+		cur_size += bytes; 
 
-		// wait to see if socket has any data
-		ret = select((int) sock + 1, &fd, NULL, NULL, &timeout);
-		if (ret > 0)
+		// look for the blank line ending the header, which may straddle the previous chunk
+		while (header_len == 0 && bytes > 0)
 		{
-			// new data available
-			int bytes = recv(sock, buf + cur_size, (int) (allocated_size - cur_size), NULL);
-			if (bytes < 0)
+			const char header_end[] = "\r\n\r\n";
+			const char *end = search(buf + header_from, buf + cur_size, header_end, header_end + 4);
+			if (end == buf + cur_size)
 			{
-				printf("failed with %d on recv\n", WSAGetLastError());
-				return -1;
+				header_from = (cur_size > 3) ? cur_size - 3 : 0;
+				break;
 			}
 
-			// advance current position by number of bytes read
-			cur_size += bytes; 
-			
-			// buffer needs to be expanded
-			if (allocated_size - cur_size < BUF_SIZE_THRESHOLD)
-			{   
-				// make sure allocated_size will not overflow
-				if (2 * allocated_size < allocated_size) 
-				{   
-					printf("failed with buffer overflow\n");
-					free(buf);
-					buf = NULL;
-					cur_size = 0;
-					allocated_size = 0;
-					return -1;
-				}
-
-			    // expand memory for buffer, making sure the expansion succeeds
-				char* temp = (char*) realloc(buf, 2 * allocated_size); 
-				if (temp == NULL)
-				{
-					printf("realloc failed for buffer\n");
-					free(buf);
-					buf = NULL;
-					cur_size = 0;
-					allocated_size = 0;
-					return -1;
-				}
+			// interim responses (100 Continue) come before the real one, drop them and look for the next header
+			header_len = end + 4 - buf;
+			if (ParseFraming(buf) / 100 == 1)
+			{
+				memmove(buf, buf + header_len, cur_size - header_len);
+				cur_size -= header_len;
+				header_len = 0;
+				header_from = 0;
+				continue;
+			}
 
-                // double allocated size with each expansion (higher overhead but faster)
-				allocated_size *= 2; 
-				buf = temp;
+			// chunked bodies interleave chunk sizes with the HTML, leave those to the full parser
+			if (chunked)
+			{
+				stream = false;
+				chunk_pos = header_len;
 			}
-			// connection closed
-			if (bytes == 0) 
+			fed = header_len;
+		}
+
+		// chunk sizes are not part of the page, so a chunked body is fingerprinted one chunk's data at a time
+		if (chunked)
+		{
+			ScanChunks(buf, cur_size, hashing);
+			fed = cur_size;
+		}
+
+		// extract links from and fingerprint the new data while the rest of the page downloads
+		else if (hashing && header_len > 0 && cur_size > fed)
+		{
+			if (stream)
 			{
-				if (buf == NULL)
-				{
-					printf("nothing written to buffer\n");
-					cur_size = 0;
-					allocated_size = 0;
-					return -1;
-				}
-
-				char* response_pos = strstr(buf, "HTTP/");
-				// response not found, clean up and return
-				if (response_pos == NULL)
-				{   
-					printf("failed with non-HTTP header\n");
-					return -1;
-				}
-
-				stop_time = chrono::high_resolution_clock::now();
-				/* Null-terminate buffer
-				 *
-				 * Warning C6386 due to indexing by cur_size, but buffer overflow is not possible because 
-				 * allocated_size is strictly > cur_size while BUF_SIZE_THRESHOLD > 0 
-				 */
-				buf[cur_size] = '\0'; 
-
-				printf("done in %" PRIu64 " ms with %zu bytes\n", 
-					   chrono::duration_cast<chrono::milliseconds>
-					   (stop_time - start_time).count(), cur_size);
-				return 0;
+				auto feed_start = chrono::high_resolution_clock::now();
+				stream_parser.Feed(buf + fed, cur_size - fed);
+				stream_time += chrono::high_resolution_clock::now() - feed_start;
 			}
+			hasher.Feed(buf + fed, cur_size - fed);
+			fed = cur_size;
 		}
-		// socket timed out
-		else if (ret == 0) 
+
+		// a keep-alive response ends when its framing says so rather than when the connection closes
+		bool complete = ResponseComplete(buf, cur_size);
+		
+		// buffer needs to be expanded
+		if (allocated_size - cur_size < BUF_SIZE_THRESHOLD)
 		{   
-			stop_time = chrono::high_resolution_clock::now();
-			printf("socket timeout\n");
-			return -1;
+			// make sure allocated_size will not overflow
+			if (2 * allocated_size < allocated_size) 
+			{   
+				Log("failed with buffer overflow\n");
+				free(buf);
+				buf = NULL;
+				cur_size = 0;
+				allocated_size = 0;
+				return -1;
+			}
+
+		    // expand memory for buffer, making sure the expansion succeeds
+			char* temp = (char*) realloc(buf, 2 * allocated_size); 
+			if (temp == NULL)
+			{
+				Log("realloc failed for buffer\n");
+				free(buf);
+				buf = NULL;
+				cur_size = 0;
+				allocated_size = 0;
+				return -1;
+			}
+
+                // double allocated size with each expansion (higher overhead but faster)
+			allocated_size *= 2; 
+			buf = temp;
 		}
-		else
+		// connection closed or response complete
+		if (bytes == 0 || complete) 
 		{
-			printf("failed with %d on select\n", WSAGetLastError());
-			return -1;
+			if (buf == NULL)
+			{
+				Log("nothing written to buffer\n");
+				cur_size = 0;
+				allocated_size = 0;
+				return -1;
+			}
+
+			char* response_pos = strstr(buf, "HTTP/");
+			// response not found, clean up and return
+			if (response_pos == NULL)
+			{   
+				Log("failed with non-HTTP header\n");
+				return -1;
+			}
+
+			stop_time = chrono::high_resolution_clock::now();
+			/* Null-terminate buffer
+			 *
+			 * Warning C6386 due to indexing by cur_size, but buffer overflow is not possible because 
+			 * allocated_size is strictly > cur_size while BUF_SIZE_THRESHOLD > 0 
+			 */
+			buf[cur_size] = '\0'; 
+			streamed = stream && header_len > 0;
+			if (hashing)
+				fingerprint = hasher.Finish();
+			reusable = complete && keep_alive && !secure;
+
+			Log("done in %" PRIu64 " ms with %zu bytes\n", 
+				chrono::duration_cast<chrono::milliseconds>
+				(stop_time - start_time).count(), cur_size);
+			return 0;
 		}
 
 		stop_time = chrono::high_resolution_clock::now();
@@ -274,11 +470,11 @@ int WebCrawler::Read(char* &buf, const size_t read_limit, size_t &cur_size, size
 	// buf has advanced more than read_limit bytes
 	if (cur_size >= read_limit)
 	{
-		printf("failed with exceeding max\n");
+		Log("failed with exceeding max\n");
 		return -1;
 	}
 	// connection timer expired
-	printf("connection timeout\n");
+	Log("connection timeout\n");
 	return -1;
 }
 
@@ -296,17 +492,17 @@ bool WebCrawler::VerifyHeader(char* buf, int min_response, int max_response)
 		// response code could not be extracted
 		if (sscanf_s(response_pos, "%*s %d", &response) <= 0)
 		{   
-			printf("failed with non-HTTP header\n");
+			Log("failed with non-HTTP header\n");
 			return false;
 		}
 	}
 	else
 	{   
-		printf("failed with non-HTTP header\n");
+		Log("failed with non-HTTP header\n");
 		return false;
 	}
 
-	printf("status code %d\n", response);
+	Log("status code %d\n", response);
 
 	if (response >= min_response && response <= max_response)
 	{
@@ -316,76 +512,251 @@ bool WebCrawler::VerifyHeader(char* buf, int min_response, int max_response)
 	return false;
 }
 
-// parses HTTP response and finds number of links in HTML buffer
-int WebCrawler::Parse(char *buf, size_t size, bool print)
+// copies the value of the named field from an HTTP header into value, returns false if the field is not present
+bool WebCrawler::GetHeaderField(const char *header, size_t header_len, const char *field, string &value)
 {
-	int num_links = -1;
-	char *base_url = NULL;   
-	string base_url_string = url.scheme + "://" + url.host;
+	const char *end = header + header_len;
+	const char *line = header;
+	size_t field_len = strlen(field);
 
-	base_url = (char*)malloc(MAX_URL_LEN); 
-	if (base_url == NULL)
+	while (line < end)
 	{
-		printf("malloc failure for base URL\n");
-		return -1;
+		const char *line_end = search(line, end, "\r\n", "\r\n" + 2);
+
+		// field names are case insensitive and immediately followed by ':'
+		if ((size_t) (line_end - line) > field_len && _strnicmp(line, field, field_len) == 0 && line[field_len] == ':')
+		{
+			const char *val = line + field_len + 1;
+			while (val < line_end && isspace((unsigned char) *val))
+				val++;
+
+			value.assign(val, line_end - val);
+			return true;
+		}
+
+		line = line_end + 2;
 	}
 
-	// create C-style string with base URL
-	strcpy_s(base_url, MAX_URL_LEN, base_url_string.c_str());
+	return false;
+}
 
-	// start timer
-	start_time = chrono::high_resolution_clock::now(); 
+// sets the framing members from the complete HTTP header at the start of buf unless it is interim (1XX), returns its status code
+int WebCrawler::ParseFraming(const char *buf)
+{
+	string value;
 
-	// get number of links from response
-	char* link_buffer = parser.Parse(buf, (int)size, base_url, (int)strlen(base_url), &num_links);
-	if (num_links < 0)
+	// status code follows the protocol version
+	int status = 0;
+	const char *space = (const char*) memchr(buf, ' ', header_len);
+	if (space != NULL)
 	{
-		printf("HTML parsing error\n");
-		free(base_url);
-		return -1;
+		for (const char *pos = space + 1; pos < buf + header_len && isdigit((unsigned char) *pos); pos++)
+			status = status * 10 + (*pos - '0');
 	}
 
-	// stop timer and print information
-	stop_time = chrono::high_resolution_clock::now();
-	printf("done in %" PRIu64 " ms with %d links\n", chrono::duration_cast<chrono::milliseconds>(stop_time - start_time).count(), num_links);
+	// an interim response is followed by the real one, which has the framing
+	if (status >= 100 && status < 200)
+		return status;
+
+	// responses to HEAD, 204 and 304 never have a body
+	if (head_request || status == 204 || status == 304)
+		body_len = 0;
+	else if (GetHeaderField(buf, header_len, "Transfer-Encoding", value))
+	{
+		transform(value.begin(), value.end(), value.begin(), ::tolower);
+		chunked = value.find("chunked") != string::npos;
+	}
+	else if (GetHeaderField(buf, header_len, "Content-Length", value))
+	{
+		char *end = NULL;
+		long long len = strtoll(value.c_str(), &end, 10);
+		if (end != value.c_str() && len >= 0)
+			body_len = len;
+	}
+
+	// HTTP/1.1 connections persist unless either side says otherwise
+	keep_alive = strncmp(buf, "HTTP/1.1", 8) == 0;
+	if (GetHeaderField(buf, header_len, "Connection", value))
+	{
+		transform(value.begin(), value.end(), value.begin(), ::tolower);
+		if (value.find("close") != string::npos)
+			keep_alive = false;
+		else if (value.find("keep-alive") != string::npos)
+			keep_alive = true;
+	}
+
+	return status;
+}
+
+/*
+ * Function: ScanChunks
+ * ------------------
+ * Follows a chunked body from where the last call stopped: reads each chunk's
+ * size line, skips over its data and the line break after it, and after the
+ * zero length chunk reads trailer lines up to the blank line that ends the
+ * body. A line that has not been received completely is scanned again on the
+ * next call. A size line that is not hexadecimal means the body cannot be
+ * framed, so it is read until the connection closes instead (and fingerprinted
+ * as it is from then on).
+ *
+ * input:
+ *   - buf: the response received so far
+ *   - cur_size: number of bytes in buf
+ *   - hash: feed the data of each chunk to the fingerprint
+ */
+void WebCrawler::ScanChunks(const char *buf, size_t cur_size, bool hash)
+{
+	while (chunk_pos < cur_size && chunk_state != ChunkState::DONE)
+	{
+		if (chunk_state == ChunkState::DATA)
+		{
+			size_t data = (size_t) min(chunk_left, (uint64_t) (cur_size - chunk_pos));
+			if (hash)
+				hasher.Feed(buf + chunk_pos, data);
+			chunk_pos += data;
+			chunk_left -= data;
+			if (chunk_left == 0)
+				chunk_state = ChunkState::DATA_END;
+			continue;
+		}
+
+		// every other state reads a whole line
+		const char *line = buf + chunk_pos;
+		const char *line_end = (const char*) memchr(line, '\n', cur_size - chunk_pos);
+		if (line_end == NULL)
+			return;
+		size_t line_len = line_end - line;
+		chunk_pos += line_len + 1;
+
+		switch (chunk_state)
+		{
+		// hexadecimal size, optionally followed by extensions after ';'
+		case ChunkState::SIZE:
+		{
+			char *end = NULL;
+			chunk_left = isxdigit((unsigned char) *line) ? strtoull(line, &end, 16) : 0;
+			if (end == NULL || end == line)
+			{
+				if (hash)
+					hasher.Feed(line, buf + cur_size - line);
+				chunked = false;
+				keep_alive = false;
+				return;
+			}
+			chunk_state = (chunk_left == 0) ? ChunkState::TRAILER : ChunkState::DATA;
+			break;
+		}
+
+		// line break after the chunk's data
+		case ChunkState::DATA_END:
+			chunk_state = ChunkState::SIZE;
+			break;
+
+		// trailer fields end with a blank line
+		case ChunkState::TRAILER:
+			if (line_len == 0 || (line_len == 1 && *line == '\r'))
+				chunk_state = ChunkState::DONE;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+// true if the response in buf has been received completely according to its framing
+bool WebCrawler::ResponseComplete(const char *buf, size_t cur_size) const
+{
+	if (header_len == 0)
+		return false;
+
+	if (body_len >= 0)
+		return cur_size >= header_len + (size_t) body_len;
+
+	// chunked body ends with a zero length chunk, its trailer and the blank line after it
+	if (chunked)
+		return chunk_state == ChunkState::DONE;
+
+	// body runs until the connection closes
+	return false;
+}
+
+// parses HTTP response and returns number of links in HTML buffer or -1 for failure (reports links found during Read if it was streamed)
+int WebCrawler::Parse(char *buf, size_t size, bool print)
+{
+	int num_links = -1;
+
+	// links were already extracted while the page was downloading
+	if (streamed)
+	{
+		num_links = stream_parser.NumLinks();
+		Log("done in %" PRIu64 " ms with %d links\n", chrono::duration_cast<chrono::milliseconds>(stream_time).count(), num_links);
+	}
+	else
+	{
+		pmr::memory_resource *mem = url->Resource();
+		char *base_url = (char*) mem->allocate(MAX_URL_LEN, 1);
+
+		// create C-style string with base URL, which the parser requires to be http:// even for https pages
+		sprintf_s(base_url, MAX_URL_LEN, "http://%s", url->host.c_str());
+
+		// start timer
+		start_time = chrono::high_resolution_clock::now(); 
+
+		// get number of links from response
+		char* link_buffer = parser.Parse(buf, (int)size, base_url, (int)strlen(base_url), &num_links);
+		mem->deallocate(base_url, MAX_URL_LEN, 1); 
+		if (num_links < 0)
+		{
+			Log("HTML parsing error\n");
+			return -1;
+		}
+
+		// stop timer and print information
+		stop_time = chrono::high_resolution_clock::now();
+		Log("done in %" PRIu64 " ms with %d links\n", chrono::duration_cast<chrono::milliseconds>(stop_time - start_time).count(), num_links);
+	}
 	
 	if (print)
 	{
-		printf("___________________________________________________________________________________\n");
+		Log("___________________________________________________________________________________\n");
 
 		// extract and print HTTP header
 		char* header_end = strstr(buf, "\r\n\r\n");
 		if (header_end == NULL)
 		{
-			printf("unexpected error printing HTTP header\n");
-			free(base_url);
+			Log("unexpected error printing HTTP header\n");
 			return -1;
 		}
 
 		*header_end = '\0';
-		printf("%s\r\n", buf);
+		Log("%s\r\n", buf);
 	}
 
-	// clean up
-	free(base_url); 
-	return 0;
+	return num_links;
 }
 
-// resets socket connection
-int WebCrawler::ResetConnection()
+// closes the socket connection, or returns it to the pool if keep is set and it can be reused
+int WebCrawler::ResetConnection(bool keep)
 {
-	if (closesocket(sock) == SOCKET_ERROR)
+	int ret = 0;
+
+	tls.Close();
+	secure = false;
+
+	// the pool closes the socket itself if it cannot be reused
+	if (has_slot)
 	{
-		printf("closesocket generated error %d\n", WSAGetLastError());
-		return -1;
+		pool->Release(pool_key, sock, keep && reusable);
+		has_slot = false;
 	}
-
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (sock == INVALID_SOCKET)
+	else if (sock != INVALID_SOCKET && closesocket(sock) == SOCKET_ERROR)
 	{
-		printf("socket() generated error %d\n", WSAGetLastError());
-		return -1;
+		Log("closesocket generated error %d\n", WSAGetLastError());
+		ret = -1;
 	}
 
-	return 0;
+	sock = INVALID_SOCKET;
+	reusable = false;
+	return ret;
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 
 const std::string AGENT_NAME = "CPPWebCrawler/1.2";
 
+// fixed part of every request between the request target and the host name
+const std::string REQUEST_AGENT = " HTTP/1.1\r\nUser-agent: " + AGENT_NAME + "\r\nHost: ";
+
 // initial buffer size is 8KB
 const UINT INITIAL_BUF_SIZE = 8 * 1024;
 
@@ -22,47 +25,114 @@ const UINT MAX_CONNECTION_TIME = 10;
 // max time without read response before socket times out
 const UINT TIMEOUT_SECONDS = 10;
 
+class ConcurrencyController;
+
 class WebCrawler
 {
 	HTMLParserBase parser;
-	ParsedURL url;
+	StreamParser stream_parser;
+	const ParsedURL *url; // set by SetUrl, not owned
 	SOCKET sock;
 
+	// TLS state for https URLs, secure is set once the handshake has completed
+	TLSConnection tls;
+	bool secure;
+
+	// shared pool of idle keep-alive connections, nullptr to close every connection after use
+	ConnectionPool *pool;
+	std::string pool_key; // "<host>:<port>" the current connection's slot is held for
+	bool has_slot;
+	bool reusable;        // last response was read completely and the server will keep the connection open
+	bool head_request;    // last request was HEAD, so its response has no body
+
+	// last request sent, kept so its capacity is reused
+	std::string request_buf;
+
+	// receives DNS, connect and read timings and sets the timeouts, nullptr for the fixed TIMEOUT_SECONDS
+	ConcurrencyController *controller;
+
+	// framing of the response being read, found once its header is complete
+	size_t header_len;
+	int64_t body_len;     // -1 if the body runs until the connection closes
+	bool chunked;
+	bool keep_alive;
+
+	// progress through a chunked body, kept between receives so each byte is scanned once
+	enum class ChunkState { SIZE, DATA, DATA_END, TRAILER, DONE };
+	ChunkState chunk_state;
+	size_t chunk_pos;     // offset in the buffer of the next byte to scan
+	uint64_t chunk_left;  // data bytes left in the current chunk
+
+	// false if pages are parsed elsewhere, so Read leaves links to be found later
+	bool stream_links;
+
+	// true if links for the last page read were extracted while it was downloading
+	bool streamed;
+
+	// time spent in the stream parser during the last read
+	std::chrono::high_resolution_clock::duration stream_time;
+
+	// fingerprint of the body of the last page read
+	ContentHasher hasher;
+	PageFingerprint fingerprint;
+
 	struct hostent* remote;    // structure used in DNS lookups
 	struct sockaddr_in server; // structure for connecting to server
 
 	// Beginning and end time points for timer implementation
 	std::chrono::time_point<std::chrono::high_resolution_clock> start_time, stop_time; 
 
+	// copies the value of the named field from an HTTP header into value, returns false if the field is not present
+	static bool GetHeaderField(const char *header, size_t header_len, const char *field, std::string &value);
+
+	// connects sock to server within timeout_ms, returns 0 for success or the Winsock error code
+	int Connect(DWORD timeout_ms);
+
+	// sets the framing members from the complete HTTP header at the start of buf unless it is interim (1XX), returns its status code
+	int ParseFraming(const char *buf);
+
+	// follows the chunk sizes of a chunked body through the bytes received up to cur_size, fingerprinting its data if hash is set
+	void ScanChunks(const char *buf, size_t cur_size, bool hash);
+
+	// true if the response in buf has been received completely according to its framing
+	bool ResponseComplete(const char *buf, size_t cur_size) const;
+
 public:
-	// basic constructor initializes winsock and opens a TCP socket
-	WebCrawler(ParsedURL _url = ParsedURL()); 
+	// basic constructor initializes winsock, connections are drawn from _pool and timings reported to _controller when they are given
+	WebCrawler(ConnectionPool *_pool = nullptr, ConcurrencyController *_controller = nullptr); 
 
 	// destructor cleans up winsock and closes socket
 	~WebCrawler(); 
 
-	// basic setter for the url data member
-	void SetUrl(ParsedURL _url);
+	// basic setter for the url data member, _url must outlive its use by the crawler
+	void SetUrl(const ParsedURL &_url);
 
 	// resolves DNS for the host specified by the url member and returns an IP address or -1 for failure
 	int ResolveDNS();
 
-	// creates a TCP connection to a server, returns -1 for failure and 0 for success
+	// creates a TCP connection to a server (with a TLS session on top for https) or reuses a pooled one, returns -1 for failure and 0 for success
 	int CreateConnection(); 
 
-	// writes a properly formatted HTTP query to the connected server, returns -1 for failure and 0 for success
-	int Write(std::string request_type, std::string request = ""); 
+	// writes an HTTP request for target (the url's own if empty) to the connected server, asking the server to close the connection
+	// after it if last is set, returns -1 for failure and 0 for success
+	int Write(std::string_view method, std::string_view target = std::string_view(), bool last = false);
 
 	// checks HTTP header in buf and returns true if the response code is between min_response and max_response (inclusive), false otherwise
 	bool VerifyHeader(char *buf, int min_response, int max_response);
 
-	// receives HTTP response from connected server
-	int Read(char* &buf, size_t read_limit, size_t &cur_size, size_t &allocated_size); 
+	// receives HTTP response from connected server, extracting links from the body and fingerprinting it as it arrives if stream is set
+	int Read(char* &buf, size_t read_limit, size_t &cur_size, size_t &allocated_size, bool stream = false); 
+
+	// turns link extraction during Read on or off, the page is still fingerprinted either way
+	void SetStreamLinks(bool enabled) { stream_links = enabled; }
+
+	// fingerprint of the body of the last page read with stream set
+	const PageFingerprint &Fingerprint() const { return fingerprint; }
 
-	// parses HTTP response and finds number of links in HTML buffer
+	// parses HTTP response and returns number of links in HTML buffer or -1 for failure (reports links found during Read if it was streamed)
 	int Parse(char* buf, size_t size, bool print); 
 
-	// resets socket connection
-	int ResetConnection();
+	// closes the socket connection, or returns it to the pool if keep is set and it can be reused
+	int ResetConnection(bool keep = true);
 };
 
@@ -11,14 +11,14 @@
 
 #pragma comment(lib, "ws2_32.lib")
 
-// valid number of command line args 
+// number of required command line args, options may follow
 const unsigned NUM_ARGS = 3; 
 
 // smallest valid number of threads
 const unsigned MIN_NUM_THREADS = 1; 
 
 // largest valid number of threads
-const unsigned MAX_NUM_THREADS = 1; 
+const unsigned MAX_NUM_THREADS = 1000; 
 
 // max size of robots.txt to download (16KB)
 const size_t   MAX_ROBOTS_SIZE = 16 * 1024; 
@@ -28,50 +28,302 @@ const size_t   MAX_PAGE_SIZE = 2 * 1024 * 1024;
 
 using namespace std;
 
+// state shared by every crawler thread
+struct SharedCrawl
+{
+	// input file, its position and the statistics, guarded by lock
+	FILE *file;
+	int64_t next_offset;       // start of the next line to be read
+	set<int64_t> in_progress;  // starts of the lines being crawled
+	CrawlStats &stats;
+	bool failed;
+	mutex lock;
+
+	// uniqueness sets, guarded by seen_lock
+	unordered_set<DWORD> &seen_ips;
+	unordered_set<string> &seen_hosts;
+	mutex seen_lock;
+
+	// each URL's trace is printed in one piece when there are several threads
+	bool buffered;
+	mutex print_lock;
+
+	// thread safe on their own
+	Checkpoint &checkpoint;
+	ConnectionPool pool;
+	FingerprintIndex fingerprints;
+	ConcurrencyController controller;
+	ParsePool *parse_pool; // nullptr if fetch threads parse their own pages
+	Archive *archive;      // nullptr if pages are not archived
+
+	SharedCrawl(FILE *_file, unordered_set<DWORD> &_seen_ips, unordered_set<string> &_seen_hosts, Checkpoint &_checkpoint,
+	            CrawlStats &_stats, unsigned num_threads, Archive *_archive)
+		: file{ _file }, next_offset{ _ftelli64(_file) }, stats{ _stats }, failed{ false }, seen_ips{ _seen_ips }, seen_hosts{ _seen_hosts },
+		  buffered{ num_threads > 1 }, checkpoint{ _checkpoint }, controller{ num_threads }, parse_pool{ nullptr }, archive{ _archive } {}
+};
+
 /*
- * Function: CrawlUrls
+ * Function: FinishUrl
  * ------------------
- * Crawls through a list of URLs in a given input file, initiating connection
- * if the crawler has not attempted to connect to the host before and 
- * first requesting the HTTP header for /robots.txt. If robots.txt is not found
- * (4XX) response code then the page specified by the URL is requested and 
- * parsed to find the number of links on the page.
+ * Adds a completed URL's counts to the totals and records how far through the
+ * input file every URL is complete. The host and IP the URL added to the
+ * uniqueness sets go to the checkpoint in the same record as the progress, so
+ * a snapshot never holds a URL's host while its line is still ahead of the
+ * saved offset, which would make a resumed crawl skip it.
  *
  * input:
- *   - seen_ips: data structure to hold the list of IP addresses visited by the crawler
- *   - seen_hosts: data structure to hold the list of hosts visited by the crawler
- *   - file: an open input file containing the URLs that should be crawled
+ *   - shared: state shared with the crawler threads
+ *   - line_start: start of the URL's line in the input file
+ *   - url_stats: counts for the URL
+ *   - host, IP: host and IP the URL added to the uniqueness sets, empty and 0 for none
+ */
+void FinishUrl(SharedCrawl &shared, int64_t line_start, const CrawlStats &url_stats, string_view host, DWORD IP)
+{
+	lock_guard<mutex> guard(shared.lock);
+	shared.stats += url_stats;
+	shared.in_progress.erase(line_start);
+
+	// every line before the earliest one still in progress has been completed
+	int64_t completed = shared.in_progress.empty() ? shared.next_offset : *shared.in_progress.begin();
+	shared.checkpoint.RecordProgress(completed, shared.stats, host, IP);
+}
+
+/*
+ * Function: CrawlUrl
+ * ------------------
+ * Crawls a single URL, initiating connection if the crawler has not attempted
+ * to connect to the host before and first requesting the HTTP header for
+ * /robots.txt. If robots.txt is not found (4XX) response code then the page
+ * specified by the URL is requested and parsed to find the number of links on
+ * the page, unless its content matches (exactly or nearly) a page that was
+ * already crawled. Unique pages are copied to the archive, if there is one.
+ * With a parse pool the page is handed to it instead, along with the buffer it
+ * was downloaded into, and the pool finishes the URL.
  *
- * return: a status code that will be -1 in the case that an error is encountered,
- *         or 0 for successful execution
+ * input:
+ *   - url: a line read from the input file
+ *   - line_start: start of url's line in the input file
+ *   - crawler, arena: the calling thread's crawler and per-URL memory, arena has been reset
+ *   - buffer, cur_buf_size, allocated_size: the calling thread's download buffer, left
+ *     empty if the page was handed to the parse pool
+ *   - shared: state shared with the other crawler threads
+ * output:
+ *   - url_stats: counts for this URL, to be added to the crawl's totals
+ *   - added_host, added_ip: host and IP this URL added to the uniqueness sets, left empty and 0 if it added none
+ *
+ * return: true if the URL was handed to the parse pool, false if the caller must finish it
  */
-int CrawlUrls(unordered_set<DWORD> &seen_ips, unordered_set<string> &seen_hosts, FILE* file)
+bool CrawlUrl(const char *url, int64_t line_start, WebCrawler &crawler, Arena &arena, char* &buffer, size_t &cur_buf_size,
+	          size_t &allocated_size, SharedCrawl &shared, CrawlStats &url_stats, string &added_host, DWORD &added_ip)
 {
-	if (!file)
+	// parse the URL read from the file
+	// --------------------------------------------------------------------
+	pmr::string url_string(url, &arena);
+
+	// remove carriage return and newline since they are not valid URI characters
+	url_string.erase(remove(url_string.begin(), url_string.end(), '\r'), url_string.end());
+	url_string.erase(remove(url_string.begin(), url_string.end(), '\n'), url_string.end());
+
+	url_stats.urls++;
+	Log("URL: %s\n", url_string.c_str());
+	Log("\tParsing URL... ");
+	ParsedURL parsed_url = ParsedURL::ParseUrl(url_string, &arena);
+
+	if (!parsed_url.valid)
+		return false;
+
+	// link the parsed URL with the crawler
+	crawler.SetUrl(parsed_url);
+
+	// check uniqueness of hostname and IP address
+	// --------------------------------------------------------------------
+	Log("\tChecking host uniqueness... ");
+	bool new_host;
 	{
-		printf("error: input file has not yet been opened for reading\n");
-		return -1;
+		lock_guard<mutex> guard(shared.seen_lock);
+		new_host = shared.seen_hosts.emplace(parsed_url.host).second;
 	}
-	
+	if (!new_host)
+	{
+		Log("failed\n");
+		return false;
+	}
+	Log("passed\n");
+	url_stats.unique_hosts++;
+	added_host.assign(parsed_url.host.data(), parsed_url.host.size());
+
+	Log("\tDoing DNS... ");
+	DWORD IP = crawler.ResolveDNS();
+	if (IP == NULL)
+		return false;
+	url_stats.dns_lookups++;
+
+	Log("\tChecking IP uniqueness... ");
+	bool new_ip;
+	{
+		lock_guard<mutex> guard(shared.seen_lock);
+		new_ip = shared.seen_ips.insert(IP).second;
+	}
+	if (!new_ip)
+	{
+		Log("failed\n");
+		return false;
+	}
+	Log("passed\n");
+	url_stats.unique_ips++;
+	added_ip = IP;
+
+	// check /robots.txt
+	// --------------------------------------------------------------------------
+	Log("\tConnecting on robots... ");
+	if (crawler.CreateConnection() < 0)
+		return false;
+
+	if (crawler.Write("HEAD", "/robots.txt") < 0)
+		return false;
+
+	Log("\tLoading... ");
+	if (crawler.Read(buffer, MAX_ROBOTS_SIZE, cur_buf_size, allocated_size) < 0)
+		return false;
+
+	Log("\tVerifying Header... ");
+	if (!crawler.VerifyHeader(buffer, 400, 499))
+		return false;
+	url_stats.robots_passed++;
+
+	// connect to page
+	// --------------------------------------------------------------------
+	crawler.ResetConnection();
+
+	Log("      * Connecting to page... ");
+	if (crawler.CreateConnection() < 0)
+		return false;
+
+	// hosts are only visited once, so nothing will use the connection after the page
+	if (crawler.Write("GET", string_view(), true) < 0)
+		return false;
+
+	Log("\tLoading... ");
+	if (crawler.Read(buffer, MAX_PAGE_SIZE, cur_buf_size, allocated_size, true) < 0)
+		return false;
+
+	Log("\tVerifying header... ");
+	if (!crawler.VerifyHeader(buffer, 200, 299)) 
+		return false;
+
+	url_stats.pages++;
+	url_stats.bytes += cur_buf_size;
+
+	// fingerprint was taken while the page downloaded, skipping a duplicate saves the parse only if the page would go to the
+	// parse pool, since the stream parser has already counted its links by now
+	Log("\tChecking content... ");
+	FingerprintIndex::Match match = shared.fingerprints.Insert(crawler.Fingerprint());
+	if (match != FingerprintIndex::Match::UNIQUE)
+	{
+		Log("%s duplicate\n", (match == FingerprintIndex::Match::EXACT) ? "exact" : "near");
+		url_stats.duplicates++;
+		return false;
+	}
+	Log("unique\n");
+
+	if (shared.archive != nullptr)
+		shared.archive->Add(url_string, buffer, cur_buf_size);
+
+	Log("      + Parsing page... ");
+	if (shared.parse_pool != nullptr)
+	{
+		// the job takes the buffer, this thread starts a new one for its next URL
+		ParseJob job;
+		job.buf = buffer;
+		job.size = cur_buf_size;
+		job.base_url.assign("http://").append(parsed_url.host);
+		job.line_start = line_start;
+		job.stats = url_stats;
+		job.host = added_host;
+		job.IP = added_ip;
+
+		buffer = NULL;
+		cur_buf_size = 0;
+		allocated_size = 0;
+
+		shared.parse_pool->Push(move(job));
+		Log("queued\n");
+		return true;
+	}
+
+	int num_links = crawler.Parse(buffer, cur_buf_size, false);
+	if (num_links > 0)
+		url_stats.links += num_links;
+	return false;
+}
+
+/*
+ * Function: CrawlThread
+ * ------------------
+ * Body of each crawler thread. Takes a slot from the concurrency controller,
+ * reads the next URL from the input file and crawls it, until the file runs
+ * out. Once a URL is done (here, or on a parse thread if its page was queued)
+ * its counts are added to the crawl's totals and the checkpoint is told how far
+ * through the file every URL has been completed, which is up to the earliest
+ * line another thread is still working on.
+ *
+ * input:
+ *   - shared: state shared with the other crawler threads
+ */
+void CrawlThread(SharedCrawl &shared)
+{
 	char *url = (char*) malloc(MAX_URL_LEN);
 	if (url == NULL)
 	{
 		printf("error: malloc failed for url");
-		return -1;
+		lock_guard<mutex> guard(shared.lock);
+		shared.failed = true;
+		return;
 	}
 
 	char* buffer = NULL;
-
-	ParsedURL parsed_url;
-	WebCrawler crawler;
-	size_t prev_size = 0;
 	size_t cur_buf_size = 0;
 	size_t allocated_size = 0;
 
-	while (fgets(url, MAX_URL_LEN, file) != NULL)
+	// robots.txt and page requests to a host share a keep-alive connection from the pool, closed once the URL is done
+	WebCrawler crawler(&shared.pool, &shared.controller);
+	crawler.SetStreamLinks(shared.parse_pool == nullptr);
+
+	// memory for everything that only lives while a single URL is crawled
+	Arena arena;
+
+	// host the current URL added to the uniqueness set, kept until the URL is finished
+	string added_host;
+
+	string log;
+	if (shared.buffered)
+		SetLogBuffer(&log);
+
+	for (;;)
 	{
-		printf("\n");
-		crawler.ResetConnection();
+		shared.controller.Acquire();
+
+		// take the next line, remembering where it started until it is done
+		int64_t line_start = 0;
+		bool have_url = false;
+		{
+			lock_guard<mutex> guard(shared.lock);
+			if (!shared.failed && fgets(url, MAX_URL_LEN, shared.file) != NULL)
+			{
+				line_start = shared.next_offset;
+				shared.next_offset = _ftelli64(shared.file);
+				shared.in_progress.insert(line_start);
+				have_url = true;
+			}
+		}
+		if (!have_url)
+		{
+			shared.controller.Release();
+			break;
+		}
+
+		// previous URL's strings were destroyed at the end of its iteration
+		arena.Reset();
 		
 		// buffer should be de-allocated if it is too large
 		if (allocated_size > BUF_RESET_THRESHOLD)
@@ -89,113 +341,124 @@ int CrawlUrls(unordered_set<DWORD> &seen_ips, unordered_set<string> &seen_hosts,
 			if (buffer == NULL)
 			{
 				printf("malloc failed for buffer");
-				return -1;
+				shared.controller.Release();
+				lock_guard<mutex> guard(shared.lock);
+				shared.failed = true;
+				break;
 			}
 			allocated_size = INITIAL_BUF_SIZE;
 			cur_buf_size = 0;
 		}
 
-		// parse the URL read from the file
-		// --------------------------------------------------------------------
-		string url_string(url);
-
-		// remove carriage return and newline since they are not valid URI characters
-		url_string.erase(remove(url_string.begin(), url_string.end(), '\r'), url_string.end());
-		url_string.erase(remove(url_string.begin(), url_string.end(), '\n'), url_string.end());
-
-		printf("URL: %s\n", url_string.c_str());
-		printf("\tParsing URL... ");
-		parsed_url = ParsedURL::ParseUrl(url_string);
-
-		if (!parsed_url.valid)
-			continue;
-
-		// link the parsed URL with the crawler
-		crawler.SetUrl(parsed_url);
+		CrawlStats url_stats;
+		added_host.clear();
+		DWORD added_ip = 0;
+		Log("\n");
+		bool queued = CrawlUrl(url, line_start, crawler, arena, buffer, cur_buf_size, allocated_size, shared, url_stats, added_host, added_ip);
 
-		// check uniqueness of hostname and IP address
-		// --------------------------------------------------------------------
-		printf("\tChecking host uniqueness... ");
-		prev_size = seen_hosts.size();
-		seen_hosts.insert(parsed_url.host);
-		if (seen_hosts.size() <= prev_size)
-		{
-			printf("failed\n");
-			continue;
-		}
-		printf("passed\n");
+		// give the host's connection slot back before waiting for the next URL, hosts are never
+		// visited twice so the connection is closed rather than left idle in the pool
+		crawler.ResetConnection(false);
+		shared.controller.Release();
 
-		printf("\tDoing DNS... ");
-		DWORD IP = crawler.ResolveDNS();
-		if (IP == NULL)
-			continue;
+		if (!queued)
+			FinishUrl(shared, line_start, url_stats, added_host, added_ip);
 
-		printf("\tChecking IP uniqueness... ");
-		prev_size = seen_ips.size();
-		seen_ips.insert(IP);
-		if (seen_ips.size() <= prev_size)
+		if (shared.buffered)
 		{
-			printf("failed\n");
-			continue;
+			lock_guard<mutex> guard(shared.print_lock);
+			fwrite(log.data(), 1, log.size(), stdout);
+			log.clear();
 		}
-		printf("passed\n");
-
-		// check /robots.txt
-		// --------------------------------------------------------------------------
-		printf("\tConnecting on robots... ");
-		if (crawler.CreateConnection() < 0)
-			continue;
-
-		if (crawler.Write("HEAD", "/robots.txt") < 0)
-			continue;
+	}
 
-		printf("\tLoading... ");
-		if (crawler.Read(buffer, MAX_ROBOTS_SIZE, cur_buf_size, allocated_size) < 0)
-			continue;
+	SetLogBuffer(nullptr);
+	if (buffer != NULL)
+		free(buffer);
+	free(url);
+}
 
-		printf("\tVerifying Header... ");
-		if (!crawler.VerifyHeader(buffer, 400, 499))
-			continue;
+/*
+ * Function: CrawlUrls
+ * ------------------
+ * Crawls through a list of URLs in a given input file with up to num_threads
+ * threads. How many URLs are in flight at once, and how long connects and
+ * reads may take, is left to a ConcurrencyController that adapts them to the
+ * latencies and timeouts the threads observe. If num_parse_threads is not 0,
+ * pages are parsed on a separate pool of that many threads. If archive is not
+ * nullptr, every unique page is written to it.
+ *
+ * input:
+ *   - num_threads: largest number of URLs to crawl at once
+ *   - num_parse_threads: number of parse threads, 0 to parse on the fetch threads
+ *   - seen_ips: data structure to hold the list of IP addresses visited by the crawler
+ *   - seen_hosts: data structure to hold the list of hosts visited by the crawler
+ *   - file: an open input file containing the URLs that should be crawled
+ *   - checkpoint: journal that new hosts, IPs and progress through file are recorded to
+ *   - stats: running totals for the crawl, updated as URLs are processed
+ *   - archive: started archive to copy pages to, nullptr to not archive them
+ *
+ * return: a status code that will be -1 in the case that an error is encountered,
+ *         or 0 for successful execution
+ */
+int CrawlUrls(unsigned num_threads, unsigned num_parse_threads, unordered_set<DWORD> &seen_ips, unordered_set<string> &seen_hosts, FILE* file,
+	          Checkpoint &checkpoint, CrawlStats &stats, Archive *archive)
+{
+	if (!file)
+	{
+		printf("error: input file has not yet been opened for reading\n");
+		return -1;
+	}
 
-		// connect to page
-		// --------------------------------------------------------------------
-		crawler.ResetConnection();
+	SharedCrawl shared(file, seen_ips, seen_hosts, checkpoint, stats, num_threads, archive);
 
-		printf("      * Connecting to page... ");
-		if (crawler.CreateConnection() < 0)
-			continue;
+	unique_ptr<ParsePool> parse_pool;
+	if (num_parse_threads > 0)
+	{
+		parse_pool = make_unique<ParsePool>(num_parse_threads, [&shared](ParseJob &job)
+			{ FinishUrl(shared, job.line_start, job.stats, job.host, job.IP); });
+		shared.parse_pool = parse_pool.get();
+	}
 
-		if (crawler.Write("GET") < 0)
-			continue;
+	vector<thread> threads;
+	threads.reserve(num_threads);
+	for (unsigned i = 0; i < num_threads; i++)
+		threads.emplace_back(CrawlThread, ref(shared));
 
-		printf("\tLoading... ");
-		if (crawler.Read(buffer, MAX_PAGE_SIZE, cur_buf_size, allocated_size) < 0)
-			continue;
+	for (thread &t : threads)
+		t.join();
 
-		printf("\tVerifying header... ");
-		if (!crawler.VerifyHeader(buffer, 200, 299)) 
-			continue;
+	// pages still queued count towards the totals
+	if (parse_pool)
+		parse_pool->Stop();
 
-		printf("      + Parsing page... ");
-		crawler.Parse(buffer, cur_buf_size, false);
-	}
+	checkpoint.RecordProgress(_ftelli64(file), stats);
 
-	if (buffer != NULL)
-		free(buffer);
+	if (num_threads > 1)
+		shared.controller.Print();
 
-	free(url);
-	return(EXIT_SUCCESS);
+	return shared.failed ? -1 : EXIT_SUCCESS;
 }
 
 /*
  * Function: main
  * ------------------
  * Simple driver function to validate command line arguments and call CrawlUrls
- * expects two command line arguments: number of threads and input file
+ * expects two command line arguments: number of threads and input file, followed
+ * by optional flags. Crawl state is checkpointed to <input file>.ckpt, and passing
+ * --resume reloads it and continues from where the previous crawl stopped. An
+ * existing checkpoint is never replaced unless --fresh is passed to start over, and
+ * a checkpoint that cannot be written only leaves the crawl unprotected. Passing
+ * --shards N instead splits the crawl by host across N worker processes, which
+ * are started with --shard-worker and read their URLs from stdin. Passing
+ * --parse-threads N moves page parsing onto a pool of N threads, and passing
+ * --archive <dir> writes every unique page to compressed archives in dir.
+ * Passing --insecure accepts https servers whose certificates do not validate,
+ * for testing against self-signed servers such as tls-test-server.py.
  *
  * input:
  *   - argc: count of command line arguments
- *   - argv: array of strings with three elements ["hw1p2.exe", "<number of threads>", "<input file>"]
+ *   - argv: array of strings ["hw1p2.exe", "<number of threads>", "<input file>", ["--resume" | "--fresh" | "--shards" "<N>"], ["--parse-threads" "<N>"], ["--archive" "<dir>"], ["--insecure"]]
  *
  * return: an status code that will be 1 in the case that an error is encountered,
  *         or 0 for successful execution
@@ -207,14 +470,77 @@ int main(int argc, char** argv)
 	
 	FILE* file = NULL;
 	int num_threads = 0;
+	bool resume = false;
+	bool fresh = false;
+	unsigned num_shards = 0;
+	unsigned num_parse_threads = 0;
+	int shard_index = -1;
+	string archive_dir;
+	bool insecure = false;
 	unordered_set<DWORD> seen_ips;
 	unordered_set<string> seen_hosts;
+	int64_t input_offset = 0;
+	CrawlStats stats;
+	Checkpoint checkpoint;
 	
 	// make sure command line arguments are valid
-	if (argc < NUM_ARGS || argc > NUM_ARGS)
+	if (argc < NUM_ARGS)
 	{  
-		(argc < NUM_ARGS) ? printf("too few arguments") : printf("too many arguments");
-		printf("\nusage: hw1p2.exe 1 <filename>\n");
+		printf("too few arguments");
+		printf("\nusage: hw1p2.exe 1 <filename> [--resume | --fresh | --shards <N>] [--parse-threads <N>] [--archive <dir>] [--insecure]\n");
+		return(EXIT_FAILURE);
+	}
+
+	for (int i = NUM_ARGS; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--resume") == 0)
+			resume = true;
+		else if (strcmp(argv[i], "--fresh") == 0)
+			fresh = true;
+		else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc)
+		{
+			// atoi gives 0 for anything that is not a number, which is out of range below
+			num_shards = (unsigned) atoi(argv[++i]);
+			if (num_shards < 1 || num_shards > MAX_NUM_SHARDS)
+			{
+				printf("supplied argument for shard count invalid: %s\n", argv[i]);
+				return(EXIT_FAILURE);
+			}
+		}
+		else if (strcmp(argv[i], "--parse-threads") == 0 && i + 1 < argc)
+		{
+			// atoi gives 0 for anything that is not a number, which turns the pool off
+			num_parse_threads = (unsigned) atoi(argv[++i]);
+			if (num_parse_threads > MAX_PARSE_THREADS)
+			{
+				printf("supplied argument for parse thread count invalid: %s\n", argv[i]);
+				return(EXIT_FAILURE);
+			}
+		}
+		else if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc)
+			archive_dir = argv[++i];
+		else if (strcmp(argv[i], "--insecure") == 0)
+			insecure = true;
+		else if (strcmp(argv[i], SHARD_WORKER_OPTION) == 0 && i + 1 < argc)
+			shard_index = atoi(argv[++i]);
+		else
+		{
+			printf("unknown option %s", argv[i]);
+			printf("\nusage: hw1p2.exe 1 <filename> [--resume | --fresh | --shards <N>] [--parse-threads <N>] [--archive <dir>] [--insecure]\n");
+			return(EXIT_FAILURE);
+		}
+	}
+
+	// each worker keeps only its shard of the state, so there is no single checkpoint to resume from
+	if ((resume || fresh) && (num_shards > 0 || shard_index >= 0))
+	{
+		printf("--resume and --fresh cannot be combined with --shards\n");
+		return(EXIT_FAILURE);
+	}
+
+	if (resume && fresh)
+	{
+		printf("--resume cannot be combined with --fresh\n");
 		return(EXIT_FAILURE);
 	}
 	
@@ -231,6 +557,33 @@ int main(int argc, char** argv)
 		return(EXIT_FAILURE);
 	}
 
+	// set before any crawler thread starts a handshake
+	TLSConnection::SetSkipValidation(insecure);
+
+	// the coordinator only hands out URLs, its workers each write their own archives
+	Archive archive;
+	if (!archive_dir.empty() && num_shards == 0)
+	{
+		string prefix = (shard_index >= 0) ? "archive-shard" + to_string(shard_index) : string("archive");
+		if (archive.Start(archive_dir, prefix) < 0)
+			return(EXIT_FAILURE);
+	}
+	Archive *archive_sink = archive_dir.empty() ? nullptr : &archive;
+
+	// worker for one shard, URLs come from the coordinator and the totals go back to it
+	if (shard_index >= 0)
+	{
+		int ret = CrawlUrls(num_threads, num_parse_threads, seen_ips, seen_hosts, stdin, checkpoint, stats, archive_sink);
+		if (archive_sink != nullptr)
+		{
+			archive.Stop();
+			archive.Print();
+		}
+		stats.Report(stdout);
+		fflush(stdout);
+		return (ret < 0) ? EXIT_FAILURE : 0;
+	}
+
 	// open input file for reading
 	if(fopen_s(&file, argv[2], "rb") != 0)
 	{
@@ -245,13 +598,60 @@ int main(int argc, char** argv)
 		rewind(file);
 	}
 
+	// split the crawl across worker processes
+	if (num_shards > 0)
+	{
+		fclose(file);
+		printf("\n");
+
+		int ret = 0;
+		{
+			Coordinator coordinator(argv[2], num_shards);
+			ret = coordinator.Run(num_threads, num_parse_threads, archive_dir, insecure, stats);
+		}
+		stats.Print();
+		return (ret < 0) ? EXIT_FAILURE : 0;
+	}
+
+	// reload state from the previous crawl and skip the URLs it completed
+	string checkpoint_path = string(argv[2]) + ".ckpt";
+	if (resume)
+	{
+		if (Checkpoint::Load(checkpoint_path, seen_ips, seen_hosts, input_offset, stats) < 0)
+			return(EXIT_FAILURE);
+
+		_fseeki64(file, input_offset, SEEK_SET);
+	}
+	// a forgotten --resume must not throw away the state of a long crawl
+	else if (!fresh)
+	{
+		FILE *existing = NULL;
+		if (fopen_s(&existing, checkpoint_path.c_str(), "rb") == 0 && existing != NULL)
+		{
+			fclose(existing);
+			fclose(file);
+			printf("\n%s already exists, pass --resume to continue that crawl or --fresh to start over\n", checkpoint_path.c_str());
+			return(EXIT_FAILURE);
+		}
+	}
+
+	// the crawl itself does not depend on the checkpoint, so it goes on without one
+	if (checkpoint.Start(checkpoint_path, seen_ips, seen_hosts, input_offset, stats) < 0)
+		printf("warning: crawl state will not be checkpointed\n");
+
 	// start crawling URLs
-	int ret = CrawlUrls(seen_ips, seen_hosts, file);
+	int ret = CrawlUrls(num_threads, num_parse_threads, seen_ips, seen_hosts, file, checkpoint, stats, archive_sink);
+	checkpoint.Stop();
+	archive.Stop();
 	if (ret < 0)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	stats.Print();
+	if (archive_sink != nullptr)
+		archive.Print();
+
 	// clean up by closing file
 	if (file)
 	{
@@ -9,16 +9,45 @@
 
 #include <windows.h>
 #include <inttypes.h>
+#include <stdarg.h>
+
+#define SECURITY_WIN32
+#include <security.h>
+#include <schannel.h>
+#include <compressapi.h>
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <memory_resource>
 #include <exception>
 #include <algorithm>
 #include <chrono>
 #include <unordered_set>
+#include <set>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <functional>
 
 #include "HTMLParserBase.h"
+#include "Log.h"
+#include "Arena.h"
 #include "ParsedURL.h"
+#include "StreamParser.h"
+#include "Fingerprint.h"
+#include "TLSConnection.h"
+#include "ConnectionPool.h"
 #include "WebCrawler.h"
+#include "ConcurrencyController.h"
+#include "Checkpoint.h"
+#include "BoundedQueue.h"
+#include "ParsePool.h"
+#include "Archive.h"
+#include "Coordinator.h"
 
 #endif //PCH_H
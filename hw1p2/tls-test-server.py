@@ -0,0 +1,92 @@
+# tls-test-server.py
+# CSCE 463-500
+# Luke Grammer
+# 10/19/26
+
+"""
+Local HTTPS server for testing the crawler's TLS path against URL-input-tls.txt.
+
+Serves https://localhost:4433/ with a self-signed certificate, generated with
+the openssl command line tool into tls-test-cert.pem and tls-test-key.pem the
+first time it runs. HEAD and GET of /robots.txt get a 404 so the crawler goes
+on to fetch the page, and every other path gets a small HTML page with links.
+Session tickets are left on, so the page connection can resume the session
+made by the robots.txt connection.
+
+The certificate is not trusted by Windows, so the crawler must be told to
+accept it:
+
+    python tls-test-server.py
+    hw1p2.exe 1 URL-input-tls.txt --insecure
+
+The robots.txt connection does a full handshake and the page connection logs
+"session resumed".
+"""
+
+import http.server
+import os
+import ssl
+import subprocess
+import sys
+
+PORT = 4433
+CERT_FILE = "tls-test-cert.pem"
+KEY_FILE = "tls-test-key.pem"
+
+PAGE = (b"<html><head><title>TLS test</title></head><body>\n"
+        b"<a href=\"http://localhost/a\">a</a>\n"
+        b"<a href=\"/b\">b</a>\n"
+        b"<a href=\"c.html\">c</a>\n"
+        b"</body></html>\n")
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    # sends the status line and headers for path, returns the body to send with them
+    def respond(self):
+        if self.path == "/robots.txt":
+            body = b"not found\n"
+            self.send_response(404)
+        else:
+            body = PAGE
+            self.send_response(200)
+            self.send_header("Content-Type", "text/html")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        return body
+
+    def do_HEAD(self):
+        self.respond()
+
+    def do_GET(self):
+        self.wfile.write(self.respond())
+
+
+# creates a self-signed certificate for localhost unless one is already there
+def make_certificate():
+    if os.path.exists(CERT_FILE) and os.path.exists(KEY_FILE):
+        return
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "365",
+                    "-subj", "/CN=localhost", "-keyout", KEY_FILE, "-out", CERT_FILE], check=True)
+
+
+def main():
+    os.chdir(os.path.dirname(os.path.abspath(__file__)))
+    make_certificate()
+
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(CERT_FILE, KEY_FILE)
+
+    server = http.server.ThreadingHTTPServer(("localhost", PORT), Handler)
+    server.socket = context.wrap_socket(server.socket, server_side=True)
+    print("serving https://localhost:%d/ (Ctrl+C to stop)" % PORT)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())